@@ -15,6 +15,12 @@ void setup() {
     uint8_t c = scanI2C();
 
     PRINT_DEBUG("%d devices detected", c);
+
+    // fast scan at 400 kHz, the result is kept in a bitmap
+    I2CMap_t map;
+
+    scanI2C(map, I2C_FIRST_ADDRESS, I2C_LAST_ADDRESS, 400000);
+    printI2C(map);
 }
 
 void loop() {
@@ -0,0 +1,40 @@
+// example for rr_Intervall.h
+#include <Arduino.h>
+
+#include "rr_Intervall.h"
+
+// two independent periodic jobs which share one loop
+Intervall blinkIntervall(500);
+Intervall sensorIntervall(100);
+
+// state of the blinking LED
+bool ledOn = false;
+
+// setup routine, runs once
+void setup() {
+    pinMode(LED_BUILTIN, OUTPUT);
+}
+
+// main function, runs forever
+void loop() {
+    // poll() returns immediately, nobody blocks the other job
+    if (blinkIntervall.poll() != Intervall::NotDue) {
+        ledOn = !ledOn;
+        digitalWrite(LED_BUILTIN, ledOn ? HIGH : LOW);
+    }
+
+    switch (sensorIntervall.poll()) {
+    case Intervall::Due:
+        // read a sensor
+        // ...
+        break;
+
+    case Intervall::Overrun:
+        // at least one reading has been missed
+        // ...
+        break;
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,118 @@
+//!
+//! @file rr_Clock.cpp
+//! @author M. Nickels
+//! @brief time base of the library, optionally a virtual clock for unit tests
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+
+uint64_t      VirtualClock::now       = 1000000UL;
+unsigned long VirtualClock::yieldStep = 1000;
+VirtualTimer* VirtualTimer::first     = NULL;
+
+unsigned long VirtualClock::millis(void) {
+    return now / 1000;
+}
+
+unsigned long VirtualClock::micros(void) {
+    return now;
+}
+
+void VirtualClock::delay(unsigned long ms) {
+    advance((uint64_t)ms * 1000);
+}
+
+void VirtualClock::delayMicroseconds(unsigned long us) {
+    advance(us);
+}
+
+void VirtualClock::yield(void) {
+    advance(yieldStep);
+}
+
+void VirtualClock::setYieldStep(unsigned long us) {
+    yieldStep = us;
+}
+
+void VirtualClock::set(unsigned long ms) {
+    now = (uint64_t)ms * 1000;
+
+    // the running periods restart at the new time
+    for (VirtualTimer* timer = VirtualTimer::first; timer != NULL; timer = timer->next)
+        timer->due = now + timer->period;
+}
+
+void VirtualClock::advance(uint64_t us) {
+    uint64_t target = now + us;
+
+    for (;;) {
+        VirtualTimer* earliest = NULL;
+
+        for (VirtualTimer* timer = VirtualTimer::first; timer != NULL; timer = timer->next) {
+            if (timer->due <= target && (earliest == NULL || timer->due < earliest->due))
+                earliest = timer;
+        }
+
+        if (earliest == NULL)
+            break;
+
+        // the callback may stop or restart the timer
+        now = earliest->due;
+        earliest->due += earliest->period;
+        earliest->callback(earliest->context);
+    }
+
+    now = target;
+}
+
+VirtualTimer::VirtualTimer() {
+    due      = 0;
+    period   = 0;
+    callback = NULL;
+    context  = NULL;
+    running  = false;
+    next     = NULL;
+}
+
+VirtualTimer::~VirtualTimer() {
+    stop();
+}
+
+void VirtualTimer::start(unsigned long newPeriod, Callback_t newCallback, void* newContext) {
+    stop();
+
+    if (newPeriod == 0 || newCallback == NULL)
+        return;
+
+    period   = newPeriod;
+    callback = newCallback;
+    context  = newContext;
+    due      = VirtualClock::now + period;
+    running  = true;
+    next     = first;
+    first    = this;
+}
+
+void VirtualTimer::stop(void) {
+    if (!running)
+        return;
+
+    for (VirtualTimer** link = &first; *link != NULL; link = &(*link)->next) {
+        if (*link == this) {
+            *link = next;
+            break;
+        }
+    }
+
+    running = false;
+}
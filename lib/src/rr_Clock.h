@@ -0,0 +1,154 @@
+//!
+//! @file rr_Clock.h
+//! @author M. Nickels
+//! @brief time base of the library, optionally a virtual clock for unit tests
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+
+//!
+//! @brief simulated time base
+//! @details The time only advances with delay(), advance() or yield(). Therefore timing tests run
+//!          deterministically and as fast as the CPU allows. The clock starts at 1 second, because
+//!          a time stamp of 0 is regarded as "not initialized" by the intervall classes.
+//!
+class VirtualClock {
+
+  public:
+    //!
+    //! @brief current virtual time in milliseconds
+    //!
+    //! @return unsigned long
+    //!
+    static unsigned long millis(void);
+
+    //!
+    //! @brief current virtual time in microseconds
+    //!
+    //! @return unsigned long
+    //!
+    static unsigned long micros(void);
+
+    //!
+    //! @brief advance the virtual time
+    //!
+    //! @param ms milliseconds
+    //!
+    static void delay(unsigned long ms);
+
+    //!
+    //! @brief advance the virtual time
+    //!
+    //! @param us microseconds
+    //!
+    static void delayMicroseconds(unsigned long us);
+
+    //!
+    //! @brief advance the virtual time by the yield step
+    //! @details used in busy waits, which otherwise would never terminate
+    //!
+    static void yield(void);
+
+    //!
+    //! @brief set the time yield() advances the clock
+    //!
+    //! @param us step in microseconds, default 1000
+    //!
+    static void setYieldStep(unsigned long us);
+
+    //!
+    //! @brief set the virtual time
+    //!
+    //! @param ms milliseconds
+    //!
+    static void set(unsigned long ms);
+
+  private:
+    friend class VirtualTimer;
+
+    //!
+    //! @brief advance the virtual time and call all timers, which are due on the way
+    //!
+    //! @param us microseconds
+    //!
+    static void advance(uint64_t us);
+
+    static uint64_t      now;       //!< current virtual time in microseconds
+    static unsigned long yieldStep; //!< time in microseconds which passes in yield()
+};
+
+//!
+//! @brief periodic timer on the virtual time, stand-in for hardware timers in unit tests
+//! @details Whenever the virtual time passes the end of a period, the clock is set to this time and the callback
+//!          is called, as an interrupt would be. Several timers are called in the order of their due times.
+//!
+class VirtualTimer {
+
+  public:
+    typedef void (*Callback_t)(void* context); //!< called at the end of each period
+
+    //!
+    //! @brief Construct a new Virtual Timer object, which is stopped
+    //!
+    VirtualTimer();
+
+    //!
+    //! @brief Destroy the Virtual Timer object and stop it
+    //!
+    ~VirtualTimer();
+
+    //!
+    //! @brief start the timer, the first period starts now
+    //!
+    //! @param newPeriod period in microseconds, must not be 0
+    //! @param newCallback called at the end of each period
+    //! @param newContext parameter of the callback
+    //!
+    void start(unsigned long newPeriod, Callback_t newCallback, void* newContext);
+
+    //!
+    //! @brief stop the timer
+    //!
+    void stop(void);
+
+  private:
+    friend class VirtualClock;
+
+    uint64_t      due;      //!< end of the current period in microseconds
+    unsigned long period;   //!< period in microseconds
+    Callback_t    callback; //!< called at the end of each period
+    void*         context;  //!< parameter of callback
+    bool          running;  //!< timer is in the list
+    VirtualTimer* next;     //!< next running timer
+
+    static VirtualTimer* first; //!< first running timer
+};
+
+//!
+//! @name Time base of the library
+//! @details add -DRR_VIRTUAL_CLOCK to your compiler flags to switch all timing of the library to the
+//!          VirtualClock (e.g. in the native test environment)
+//! @{
+
+#ifdef RR_VIRTUAL_CLOCK
+    #define RR_MILLIS() VirtualClock::millis() //!< current time in milliseconds
+    #define RR_MICROS() VirtualClock::micros() //!< current time in microseconds
+    #define RR_YIELD()  VirtualClock::yield()  //!< give other tasks a chance
+#else
+    #define RR_MILLIS() millis()
+    #define RR_MICROS() micros()
+    #define RR_YIELD()  yield()
+#endif
+
+//! @}
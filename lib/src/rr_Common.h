@@ -16,13 +16,30 @@
 
 #pragma once
 
+#include <stddef.h>
+
+//!
 //! @brief calculate size of an array
+//! @note ARRAY_SIZE silently returns a wrong result for pointers, use arraySize() in new code
+//!
 #define ARRAY_SIZE(array) (sizeof(array) / sizeof(array[0]))
 
 //!
-//! @brief  scan I2C bus and print result
+//! @brief calculate size of an array at compile time
+//! @details In contrast to ARRAY_SIZE a pointer does not compile. Arrays of length 0 (a GNU extension) are not
+//!          supported.
 //!
-//! @return number of devices on I2C bus
-//! @pre call Wire.begin before calling this function
+//! @tparam T type of an element
+//! @tparam N number of elements
+//! @return constexpr size_t N
 //!
-uint8_t scanI2C(void);
+template <class T, size_t N> constexpr size_t arraySize(const T (&)[N]) {
+    return N;
+}
+
+// containers without heap
+#include "rr_Containers.h"
+
+// I2C scan functions
+#include "rr_I2CDevices.h"
+#include "rr_scanI2C.h"
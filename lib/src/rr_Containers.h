@@ -0,0 +1,570 @@
+//!
+//! @file rr_Containers.h
+//! @author M. Nickels
+//! @brief containers with fixed capacity and without heap
+//! @details All containers keep their elements in an array inside the object, the capacity is a template
+//!          parameter of at most 255 elements. The elements must be default constructible and copyable. Nothing
+//!          is allocated on the heap, therefore the RAM usage is known at compile time and the heap cannot
+//!          fragment.
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// own includes
+
+//!
+//! @brief ring buffer (FIFO) of elements
+//! @details Index 0 is the oldest element. The position is calculated with a modulo, which is a mask if the
+//!          capacity is a power of two.
+//!
+//! @tparam T type of an element
+//! @tparam Capacity maximum number of elements
+//!
+template <class T, uint8_t Capacity> class RingBuffer {
+
+  public:
+    //!
+    //! @brief Construct a new empty RingBuffer object
+    //!
+    RingBuffer() {
+        clear();
+    }
+
+    //!
+    //! @brief remove all elements
+    //!
+    void clear(void) {
+        head  = 0;
+        count = 0;
+    }
+
+    //!
+    //! @brief append an element
+    //!
+    //! @param value the element
+    //! @return true if appended, false if the buffer is full
+    //!
+    bool push(const T& value) {
+        if (count >= Capacity)
+            return false;
+
+        data[(head + count++) % Capacity] = value;
+
+        return true;
+    }
+
+    //!
+    //! @brief append an element, the oldest element is dropped if the buffer is full
+    //!
+    //! @param value the element
+    //!
+    void pushOverwrite(const T& value) {
+        if (count >= Capacity)
+            drop();
+
+        push(value);
+    }
+
+    //!
+    //! @brief remove the oldest element
+    //!
+    //! @param value receives the element
+    //! @return true if successful, false if the buffer is empty
+    //!
+    bool pop(T& value) {
+        if (count == 0)
+            return false;
+
+        value = data[head];
+        drop();
+
+        return true;
+    }
+
+    //!
+    //! @brief access an element
+    //!
+    //! @param index 0 = oldest, getCount() - 1 = newest, must be less than getCount()
+    //! @return T&
+    //!
+    T& operator[](uint8_t index) {
+        return data[(head + index) % Capacity];
+    }
+
+    //!
+    //! @brief return the number of elements
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getCount(void) const {
+        return count;
+    }
+
+    //!
+    //! @brief return the maximum number of elements
+    //!
+    //! @return uint8_t
+    //!
+    static constexpr uint8_t getCapacity(void) {
+        return Capacity;
+    }
+
+    //!
+    //! @brief check if the buffer is empty
+    //!
+    //! @return true if empty
+    //!
+    bool isEmpty(void) const {
+        return count == 0;
+    }
+
+    //!
+    //! @brief check if the buffer is full
+    //!
+    //! @return true if full
+    //!
+    bool isFull(void) const {
+        return count >= Capacity;
+    }
+
+  private:
+    //! @brief remove the oldest element
+    void drop(void) {
+        head = (head + 1) % Capacity;
+        count--;
+    }
+
+    T       data[Capacity]; //!< the elements
+    uint8_t head;           //!< index of the oldest element
+    uint8_t count;          //!< number of elements
+};
+
+//!
+//! @brief vector of elements with fixed capacity
+//! @details The elements are contiguous, begin() and end() allow range based for loops.
+//!
+//! @tparam T type of an element
+//! @tparam Capacity maximum number of elements
+//!
+template <class T, uint8_t Capacity> class StaticVector {
+
+  public:
+    //!
+    //! @brief Construct a new empty StaticVector object
+    //!
+    StaticVector() {
+        count = 0;
+    }
+
+    //!
+    //! @brief remove all elements
+    //!
+    void clear(void) {
+        count = 0;
+    }
+
+    //!
+    //! @brief append an element
+    //!
+    //! @param value the element
+    //! @return T* the new element, NULL if the vector is full
+    //!
+    T* add(const T& value) {
+        if (count >= Capacity)
+            return NULL;
+
+        data[count] = value;
+
+        return &data[count++];
+    }
+
+    //!
+    //! @brief insert an element, the following elements are moved
+    //!
+    //! @param index position of the new element, at most getCount()
+    //! @param value the element
+    //! @return true if inserted, false if the vector is full or the index is invalid
+    //!
+    bool insert(uint8_t index, const T& value) {
+        if (count >= Capacity || index > count)
+            return false;
+
+        for (uint8_t position = count; position > index; position--)
+            data[position] = data[position - 1];
+
+        data[index] = value;
+        count++;
+
+        return true;
+    }
+
+    //!
+    //! @brief remove an element, the following elements are moved
+    //!
+    //! @param index position of the element
+    //! @return true if removed, false if the index is invalid
+    //!
+    bool remove(uint8_t index) {
+        if (index >= count)
+            return false;
+
+        count--;
+
+        for (uint8_t position = index; position < count; position++)
+            data[position] = data[position + 1];
+
+        return true;
+    }
+
+    //!
+    //! @brief access an element
+    //!
+    //! @param index position, must be less than getCount()
+    //! @return T&
+    //!
+    T& operator[](uint8_t index) {
+        return data[index];
+    }
+
+    //!
+    //! @brief access an element
+    //!
+    //! @param index position, must be less than getCount()
+    //! @return const T&
+    //!
+    const T& operator[](uint8_t index) const {
+        return data[index];
+    }
+
+    //!
+    //! @brief return the first element
+    //!
+    //! @return T*
+    //!
+    T* begin(void) {
+        return data;
+    }
+
+    //!
+    //! @brief return the element behind the last element
+    //!
+    //! @return T*
+    //!
+    T* end(void) {
+        return data + count;
+    }
+
+    //!
+    //! @brief return the number of elements
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getCount(void) const {
+        return count;
+    }
+
+    //!
+    //! @brief return the maximum number of elements
+    //!
+    //! @return uint8_t
+    //!
+    static constexpr uint8_t getCapacity(void) {
+        return Capacity;
+    }
+
+    //!
+    //! @brief check if the vector is empty
+    //!
+    //! @return true if empty
+    //!
+    bool isEmpty(void) const {
+        return count == 0;
+    }
+
+    //!
+    //! @brief check if the vector is full
+    //!
+    //! @return true if full
+    //!
+    bool isFull(void) const {
+        return count >= Capacity;
+    }
+
+  private:
+    T       data[Capacity]; //!< the elements
+    uint8_t count;          //!< number of elements
+};
+
+//!
+//! @brief set of bits
+//! @details bit (index % 8) of byte (index / 8), the same layout as I2CMap_t
+//!
+//! @tparam Bits number of bits
+//!
+template <uint16_t Bits> class BitSet {
+
+  public:
+    //!
+    //! @brief Construct a new BitSet object with all bits cleared
+    //!
+    BitSet() {
+        clear();
+    }
+
+    //!
+    //! @brief clear all bits
+    //!
+    void clear(void) {
+        memset(data, 0, sizeof(data));
+    }
+
+    //!
+    //! @brief set or clear a bit
+    //!
+    //! @param index the bit, invalid indices are ignored
+    //! @param value new state
+    //!
+    void set(uint16_t index, bool value = true) {
+        if (index < Bits) {
+            if (value)
+                data[index >> 3] |= 1 << (index & 7);
+            else
+                data[index >> 3] &= ~(1 << (index & 7));
+        }
+    }
+
+    //!
+    //! @brief return a bit
+    //!
+    //! @param index the bit
+    //! @return true if set, false if cleared or invalid
+    //!
+    bool get(uint16_t index) const {
+        return index < Bits && (data[index >> 3] & (1 << (index & 7)));
+    }
+
+    //!
+    //! @brief count the set bits
+    //!
+    //! @return uint16_t
+    //!
+    uint16_t count(void) const {
+        uint16_t result = 0;
+
+        for (uint16_t index = 0; index < sizeof(data); index++) {
+            // clear the lowest set bit until none is left
+            for (uint8_t bits = data[index]; bits != 0; bits &= bits - 1)
+                result++;
+        }
+
+        return result;
+    }
+
+    //!
+    //! @brief find the next set bit
+    //! @details Bytes without a set bit are skipped at once.
+    //!
+    //! @param from first bit to check
+    //! @return uint16_t index of the bit, Bits if there is none
+    //!
+    uint16_t findNext(uint16_t from = 0) const {
+        while (from < Bits) {
+            if (data[from >> 3] == 0)
+                from = (from | 7) + 1;
+            else if (get(from))
+                return from;
+            else
+                from++;
+        }
+
+        return Bits;
+    }
+
+    //!
+    //! @brief return the number of bits
+    //!
+    //! @return uint16_t
+    //!
+    static constexpr uint16_t getSize(void) {
+        return Bits;
+    }
+
+    //!
+    //! @brief return the bytes of the set
+    //!
+    //! @return uint8_t* (Bits + 7) / 8 bytes
+    //!
+    uint8_t* getData(void) {
+        return data;
+    }
+
+  private:
+    uint8_t data[(Bits + 7) / 8]; //!< the bits
+};
+
+//!
+//! @brief map with keys in ascending order
+//! @details Keys and values are kept in separate arrays, therefore the binary search only touches the keys.
+//!          Inserting and removing moves the following elements, which is cheap for small maps.
+//!
+//! @tparam Key type of a key, must support operator<
+//! @tparam Value type of a value
+//! @tparam Capacity maximum number of entries
+//!
+template <class Key, class Value, uint8_t Capacity> class SortedMap {
+
+  public:
+    //!
+    //! @brief Construct a new empty SortedMap object
+    //!
+    SortedMap() {
+        count = 0;
+    }
+
+    //!
+    //! @brief remove all entries
+    //!
+    void clear(void) {
+        count = 0;
+    }
+
+    //!
+    //! @brief insert or replace an entry
+    //!
+    //! @param key the key
+    //! @param value the value
+    //! @return true if successful, false if the key is new and the map is full
+    //!
+    bool set(const Key& key, const Value& value) {
+        uint8_t index = lowerBound(key);
+
+        if (index < count && !(key < keys[index])) {
+            values[index] = value;
+            return true;
+        }
+
+        if (count >= Capacity)
+            return false;
+
+        for (uint8_t position = count; position > index; position--) {
+            keys[position]   = keys[position - 1];
+            values[position] = values[position - 1];
+        }
+
+        keys[index]   = key;
+        values[index] = value;
+        count++;
+
+        return true;
+    }
+
+    //!
+    //! @brief find the value of a key
+    //!
+    //! @param key the key
+    //! @return Value* NULL if the key is not in the map
+    //!
+    Value* find(const Key& key) {
+        uint8_t index = lowerBound(key);
+
+        return index < count && !(key < keys[index]) ? &values[index] : NULL;
+    }
+
+    //!
+    //! @brief remove an entry
+    //!
+    //! @param key the key
+    //! @return true if removed, false if the key is not in the map
+    //!
+    bool remove(const Key& key) {
+        uint8_t index = lowerBound(key);
+
+        if (index >= count || key < keys[index])
+            return false;
+
+        count--;
+
+        for (uint8_t position = index; position < count; position++) {
+            keys[position]   = keys[position + 1];
+            values[position] = values[position + 1];
+        }
+
+        return true;
+    }
+
+    //!
+    //! @brief return a key in ascending order
+    //!
+    //! @param index position, must be less than getCount()
+    //! @return const Key&
+    //!
+    const Key& getKey(uint8_t index) const {
+        return keys[index];
+    }
+
+    //!
+    //! @brief return a value in the order of the keys
+    //!
+    //! @param index position, must be less than getCount()
+    //! @return Value&
+    //!
+    Value& getValue(uint8_t index) {
+        return values[index];
+    }
+
+    //!
+    //! @brief return the number of entries
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getCount(void) const {
+        return count;
+    }
+
+    //!
+    //! @brief return the maximum number of entries
+    //!
+    //! @return uint8_t
+    //!
+    static constexpr uint8_t getCapacity(void) {
+        return Capacity;
+    }
+
+  private:
+    //!
+    //! @brief binary search of the first key, which is not less than key
+    //!
+    //! @param key the key
+    //! @return uint8_t position, getCount() if all keys are less
+    //!
+    uint8_t lowerBound(const Key& key) const {
+        uint8_t low  = 0;
+        uint8_t high = count;
+
+        while (low < high) {
+            uint8_t middle = (low + high) / 2;
+
+            if (keys[middle] < key)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+
+        return low;
+    }
+
+    Key     keys[Capacity];   //!< keys in ascending order
+    Value   values[Capacity]; //!< values in the order of the keys
+    uint8_t count;            //!< number of entries
+};
@@ -0,0 +1,328 @@
+//!
+//! @file rr_CycleCounter.cpp
+//! @author M. Nickels
+//! @brief portable access to the CPU cycle counter
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_CycleCounter.h"
+
+#if !defined(ARDUINO) && !defined(RR_VIRTUAL_CLOCK)
+    #include <time.h>
+    #if defined(__x86_64__) || defined(__i386__)
+        #include <x86intrin.h>
+    #endif
+#endif
+
+bool                   CycleCounter::available = false;
+uint32_t               CycleCounter::frequency = 1000000UL;
+CycleCounter::Cycles_t CycleCounter::overhead  = 0;
+
+//! @brief time reference for the calibration in microseconds
+static unsigned long referenceMicros(void) {
+#if !defined(ARDUINO) && !defined(RR_VIRTUAL_CLOCK)
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long)now.tv_sec * 1000000UL + now.tv_nsec / 1000;
+#else
+    return RR_MICROS();
+#endif
+}
+
+// ----------------------------------------------------------------------------------------------------------------
+// platform specific counters
+// ----------------------------------------------------------------------------------------------------------------
+
+#if !defined(ARDUINO) && defined(RR_VIRTUAL_CLOCK)
+
+//! @brief the virtual clock in nanoseconds
+static inline CycleCounter::Cycles_t readCounter(void) {
+    return (CycleCounter::Cycles_t)((uint64_t)VirtualClock::micros() * 1000);
+}
+
+//! @brief nothing to start
+static inline bool startCounter(uint32_t& frequency) {
+    frequency = 1000000000UL;
+
+    return true;
+}
+
+#elif !defined(ARDUINO)
+
+//! @brief time stamp counter or monotonic clock in nanoseconds
+static inline CycleCounter::Cycles_t readCounter(void) {
+    #if defined(__x86_64__) || defined(__i386__)
+    return (CycleCounter::Cycles_t)__rdtsc();
+    #else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (CycleCounter::Cycles_t)((uint64_t)now.tv_sec * 1000000000UL + now.tv_nsec);
+    #endif
+}
+
+//! @brief the frequency of the time stamp counter is not known
+static inline bool startCounter(uint32_t& frequency) {
+    #if defined(__x86_64__) || defined(__i386__)
+    frequency = 0;
+    #else
+    frequency = 1000000000UL;
+    #endif
+
+    return true;
+}
+
+#elif defined(ARDUINO_ARCH_AVR)
+
+//! @brief upper 16 bit of the counter
+static volatile uint16_t overflows = 0;
+
+ISR(TIMER1_OVF_vect) {
+    overflows++;
+}
+
+//! @brief Timer1 extended by the overflow counter
+static inline CycleCounter::Cycles_t readCounter(void) {
+    uint8_t  sreg = SREG;
+    uint16_t low;
+    uint16_t high;
+
+    cli();
+
+    low  = TCNT1;
+    high = overflows;
+
+    // an overflow, which has not been handled by the interrupt yet
+    if ((TIFR1 & _BV(TOV1)) && low < 0x8000)
+        high++;
+
+    SREG = sreg;
+
+    return ((CycleCounter::Cycles_t)high << 16) | low;
+}
+
+//! @brief run Timer1 without prescaler
+static inline bool startCounter(uint32_t& frequency) {
+    if (TIMSK1 & (_BV(OCIE1A) | _BV(OCIE1B) | _BV(ICIE1)))
+        return false;
+
+    noInterrupts();
+
+    TCCR1A    = 0;
+    TCCR1B    = _BV(CS10);
+    TCNT1     = 0;
+    TIFR1     = _BV(TOV1);
+    TIMSK1    = _BV(TOIE1);
+    overflows = 0;
+
+    interrupts();
+
+    frequency = F_CPU;
+
+    return true;
+}
+
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+
+//! @brief the CCOUNT register
+static inline CycleCounter::Cycles_t readCounter(void) {
+    return ESP.getCycleCount();
+}
+
+//! @brief always running
+static inline bool startCounter(uint32_t& frequency) {
+    frequency = ESP.getCpuFreqMHz() * 1000000UL;
+
+    return true;
+}
+
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+
+    #define DEMCR      (*(volatile uint32_t*)0xE000EDFC) //!< debug exception and monitor control
+    #define DWT_CTRL   (*(volatile uint32_t*)0xE0001000) //!< DWT control
+    #define DWT_CYCCNT (*(volatile uint32_t*)0xE0001004) //!< DWT cycle counter
+
+//! @brief the DWT cycle counter
+static inline CycleCounter::Cycles_t readCounter(void) {
+    return DWT_CYCCNT;
+}
+
+//! @brief enable trace and the cycle counter
+static inline bool startCounter(uint32_t& frequency) {
+    uint32_t first;
+
+    DEMCR |= 1UL << 24;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= 1UL;
+
+    first = DWT_CYCCNT;
+
+    #ifdef F_CPU
+    frequency = F_CPU;
+    #else
+    frequency = 0;
+    #endif
+
+    // the counter is optional, it does not run if it is not implemented
+    return DWT_CYCCNT != first;
+}
+
+#elif defined(__ARM_ARCH_6M__)
+
+    #define SYST_CSR (*(volatile uint32_t*)0xE000E010) //!< SysTick control and status
+    #define SYST_RVR (*(volatile uint32_t*)0xE000E014) //!< SysTick reload value
+    #define SYST_CVR (*(volatile uint32_t*)0xE000E018) //!< SysTick current value
+
+//! @brief 24 bit SysTick extended to 32 bit, must be read at least once per 2^24 cycles
+static inline CycleCounter::Cycles_t readCounter(void) {
+    static uint32_t high = 0;
+    static uint32_t last = 0;
+    uint32_t        primask;
+    uint32_t        value;
+
+    __asm__ volatile("mrs %0, primask\n cpsid i" : "=r"(primask)::"memory");
+
+    // SysTick counts down
+    value = 0xFFFFFF - SYST_CVR;
+
+    if (value < last)
+        high += 0x1000000;
+
+    last = value;
+
+    __asm__ volatile("msr primask, %0" ::"r"(primask) : "memory");
+
+    return high + value;
+}
+
+//! @brief run SysTick from the processor clock without interrupt
+static inline bool startCounter(uint32_t& frequency) {
+    // in use by the core or an RTOS
+    if (SYST_CSR & 1UL)
+        return false;
+
+    SYST_RVR = 0xFFFFFF;
+    SYST_CVR = 0;
+    SYST_CSR = 0x5;
+
+    #ifdef F_CPU
+    frequency = F_CPU;
+    #else
+    frequency = 0;
+    #endif
+
+    return true;
+}
+
+#else
+
+//! @brief no cycle counter
+static inline CycleCounter::Cycles_t readCounter(void) {
+    return RR_MICROS();
+}
+
+//! @brief no cycle counter
+static inline bool startCounter(uint32_t& frequency) {
+    frequency = 1000000UL;
+
+    return false;
+}
+
+#endif
+
+// ----------------------------------------------------------------------------------------------------------------
+
+bool CycleCounter::begin(void) {
+    uint32_t counterFrequency = 0;
+
+    available = startCounter(counterFrequency);
+
+    if (available) {
+        frequency = counterFrequency;
+
+        if (frequency == 0)
+            calibrate();
+    }
+    else
+        frequency = 1000000UL;
+
+    // two consecutive readings
+    overhead = 0xFFFFFFFFUL;
+
+    for (uint8_t loop = 0; loop < 16; loop++) {
+        Cycles_t start = read();
+        Cycles_t delta = read() - start;
+
+        if (delta < overhead)
+            overhead = delta;
+    }
+
+    return available;
+}
+
+CycleCounter::Cycles_t CycleCounter::read(void) {
+    return available ? readCounter() : (Cycles_t)RR_MICROS();
+}
+
+uint32_t CycleCounter::getFrequency(void) {
+    return frequency;
+}
+
+uint32_t CycleCounter::calibrate(unsigned ms) {
+    unsigned long startMicros;
+    unsigned long endMicros;
+    Cycles_t      startCycles;
+    Cycles_t      cycles;
+
+    if (!available)
+        return frequency;
+
+    // synchronize to a change of the reference
+    startMicros = referenceMicros();
+    while ((endMicros = referenceMicros()) == startMicros) {
+#ifdef RR_VIRTUAL_CLOCK
+        RR_YIELD();
+#endif
+    }
+
+    startMicros = endMicros;
+    startCycles = read();
+
+    while ((endMicros = referenceMicros()) - startMicros < ms * 1000UL) {
+#ifdef RR_VIRTUAL_CLOCK
+        RR_YIELD();
+#endif
+    }
+
+    cycles = read() - startCycles;
+
+    frequency = (uint64_t)cycles * 1000000UL / (endMicros - startMicros);
+
+    return frequency;
+}
+
+CycleCounter::Cycles_t CycleCounter::getOverhead(void) {
+    return overhead;
+}
+
+uint32_t CycleCounter::toNanoseconds(Cycles_t cycles) {
+    uint64_t ns = (uint64_t)cycles * 1000000000UL / frequency;
+
+    return ns > 0xFFFFFFFFUL ? 0xFFFFFFFFUL : (uint32_t)ns;
+}
+
+uint32_t CycleCounter::toMicroseconds(Cycles_t cycles) {
+    return (uint64_t)cycles * 1000000UL / frequency;
+}
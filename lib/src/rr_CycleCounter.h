@@ -0,0 +1,123 @@
+//!
+//! @file rr_CycleCounter.h
+//! @author M. Nickels
+//! @brief portable access to the CPU cycle counter
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+
+//!
+//! @brief time measurement with CPU cycle resolution
+//! @details The counter is 32 bit wide and wraps around, differences of two readings (`read() - start`)
+//!          are correct as long as the measured time is shorter than 2^32 cycles.
+//!
+//!          | Platform                 | Source                                  | Notes                             |
+//!          | ------------------------ | --------------------------------------- | --------------------------------- |
+//!          | Cortex-M3/M4/M7          | DWT CYCCNT                              |                                   |
+//!          | Cortex-M0+ (RP2040)      | SysTick extended to 32 bit              | read at least every 2^24 cycles   |
+//!          | ESP32, ESP8266           | CCOUNT (ESP.getCycleCount())            |                                   |
+//!          | AVR                      | Timer1 without prescaler and overflows  | uses Timer1, see below            |
+//!          | native                   | rdtsc on x86, otherwise clock_gettime() | RR_VIRTUAL_CLOCK: virtual time    |
+//!
+//!          The Cortex-M0+ has no DWT cycle counter, therefore the SysTick timer is used. If SysTick is already
+//!          in use (e.g. by an RTOS) begin() fails and micros() is used as fallback.
+//!          On AVR Timer1 is switched to normal mode, this disables analogWrite() on pins 9 and 10 and must not be
+//!          combined with HardwareIntervall or the Servo library. begin() fails if a Timer1 interrupt is in use.
+//!
+class CycleCounter {
+
+  public:
+    typedef uint32_t Cycles_t; //!< number of cycles
+
+    //!
+    //! @brief start the cycle counter
+    //! @details The frequency is calibrated against micros() if it is not known at compile time
+    //!
+    //! @return true if the cycle counter is available, false if the fallback to micros() is used
+    //!
+    static bool begin(void);
+
+    //!
+    //! @brief read the cycle counter
+    //!
+    //! @return CycleCounter::Cycles_t
+    //!
+    static Cycles_t read(void);
+
+    //!
+    //! @brief return the number of cycles since start
+    //!
+    //! @param start a previous result of read()
+    //! @return CycleCounter::Cycles_t
+    //!
+    static Cycles_t elapsed(Cycles_t start) {
+        return read() - start;
+    }
+
+    //!
+    //! @brief return the frequency of the counter
+    //!
+    //! @return uint32_t cycles per second
+    //!
+    static uint32_t getFrequency(void);
+
+    //!
+    //! @brief measure the frequency of the counter against micros()
+    //!
+    //! @param ms duration of the measurement in milliseconds
+    //! @return uint32_t cycles per second
+    //!
+    static uint32_t calibrate(unsigned ms = 10);
+
+    //!
+    //! @brief return the number of cycles measured for two consecutive calls of read()
+    //! @details subtract this value from short measurements
+    //!
+    //! @return CycleCounter::Cycles_t
+    //!
+    static Cycles_t getOverhead(void);
+
+    //!
+    //! @brief convert cycles to nanoseconds
+    //!
+    //! @param cycles number of cycles
+    //! @return uint32_t nanoseconds, saturated
+    //!
+    static uint32_t toNanoseconds(Cycles_t cycles);
+
+    //!
+    //! @brief convert cycles to microseconds
+    //!
+    //! @param cycles number of cycles
+    //! @return uint32_t microseconds
+    //!
+    static uint32_t toMicroseconds(Cycles_t cycles);
+
+  private:
+    static bool     available; //!< false if micros() is used
+    static uint32_t frequency; //!< cycles per second
+    static Cycles_t overhead;  //!< cycles of an empty measurement
+};
+
+//!
+//! @brief clock policy for StaticIntervall with a period in CPU cycles
+//! @note The period of StaticIntervall is an Intervall::Period_t, which limits it to 65535 cycles on AVR.
+//!
+struct IntervallCycleClock {
+    //! @brief current time
+    static unsigned long now(void) {
+        return CycleCounter::read();
+    }
+};
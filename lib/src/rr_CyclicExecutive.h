@@ -0,0 +1,284 @@
+//!
+//! @file rr_CyclicExecutive.h
+//! @author M. Nickels
+//! @brief cyclic executive with a schedule table generated at compile time
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Intervall.h"
+
+//!
+//! @brief a task of the cyclic executive
+//!
+//! @tparam Func task function
+//! @tparam Period period in minor frame units (e.g. milliseconds), a multiple of the minor frame
+//! @tparam Budget worst case execution time in microseconds
+//!
+template <void (*Func)(void), uint16_t Period, uint32_t Budget> struct CyclicTask {
+    //! @brief return the period
+    static constexpr uint16_t getPeriod(void) {
+        return Period;
+    }
+
+    //! @brief return the worst case execution time
+    static constexpr uint32_t getBudget(void) {
+        return Budget;
+    }
+
+    //! @brief execute the task
+    static void call(void) {
+        Func();
+    }
+};
+
+//! @cond
+
+//! @brief greatest common divisor
+constexpr uint32_t cyclicGcd(uint32_t a, uint32_t b) {
+    return b == 0 ? a : cyclicGcd(b, a % b);
+}
+
+//! @brief least common multiple
+constexpr uint32_t cyclicLcm(uint32_t a, uint32_t b) {
+    return a / cyclicGcd(a, b) * b;
+}
+
+//! @brief compile time properties of a task list
+template <typename... Tasks> struct CyclicTaskSet;
+
+template <> struct CyclicTaskSet<> {
+    static constexpr uint32_t hyperPeriod(void) {
+        return 1;
+    }
+
+    static constexpr bool isMultipleOf(uint32_t) {
+        return true;
+    }
+
+    static constexpr bool isHarmonicWith(uint32_t) {
+        return true;
+    }
+
+    static constexpr bool isHarmonic(void) {
+        return true;
+    }
+
+    static constexpr uint32_t load(uint32_t) {
+        return 0;
+    }
+
+    template <uint32_t Time> static void dispatch(void) {
+    }
+};
+
+template <typename Task, typename... Rest> struct CyclicTaskSet<Task, Rest...> {
+    // least common multiple of all periods
+    static constexpr uint32_t hyperPeriod(void) {
+        return cyclicLcm(Task::getPeriod(), CyclicTaskSet<Rest...>::hyperPeriod());
+    }
+
+    // check if all periods are multiples of the minor frame
+    static constexpr bool isMultipleOf(uint32_t minorFrame) {
+        return Task::getPeriod() % minorFrame == 0 && CyclicTaskSet<Rest...>::isMultipleOf(minorFrame);
+    }
+
+    // check if period divides or is divided by all periods
+    static constexpr bool isHarmonicWith(uint32_t period) {
+        return (Task::getPeriod() % period == 0 || period % Task::getPeriod() == 0) &&
+               CyclicTaskSet<Rest...>::isHarmonicWith(period);
+    }
+
+    // check if each period divides the next longer one, i.e. all pairs divide each other
+    static constexpr bool isHarmonic(void) {
+        return CyclicTaskSet<Rest...>::isHarmonicWith(Task::getPeriod()) && CyclicTaskSet<Rest...>::isHarmonic();
+    }
+
+    // sum of the budgets of all tasks released at time
+    static constexpr uint32_t load(uint32_t time) {
+        return (time % Task::getPeriod() == 0 ? Task::getBudget() : 0) + CyclicTaskSet<Rest...>::load(time);
+    }
+
+    // call all tasks released at time, the condition is resolved by the compiler
+    template <uint32_t Time> static void dispatch(void) {
+        if (Time % Task::getPeriod() == 0)
+            Task::call();
+
+        CyclicTaskSet<Rest...>::template dispatch<Time>();
+    }
+};
+
+//! @brief larger of two values
+constexpr uint32_t cyclicMax(uint32_t a, uint32_t b) {
+    return a > b ? a : b;
+}
+
+//! @brief highest load of the frames [first, last), bisection keeps the recursion depth low
+template <typename Set>
+constexpr uint32_t cyclicMaxLoad(uint32_t first, uint32_t last, uint32_t minorFrame) {
+    return last - first == 1 ? Set::load(first * minorFrame)
+                             : cyclicMax(cyclicMaxLoad<Set>(first, (first + last) / 2, minorFrame),
+                                         cyclicMaxLoad<Set>((first + last) / 2, last, minorFrame));
+}
+
+//! @brief sequence of frame indices
+template <unsigned... Indices> struct CyclicIndices {};
+
+//! @brief append the second sequence, shifted by the length of the first one
+template <typename First, typename Second> struct CyclicConcat;
+
+template <unsigned... First, unsigned... Second>
+struct CyclicConcat<CyclicIndices<First...>, CyclicIndices<Second...> > {
+    typedef CyclicIndices<First..., (sizeof...(First) + Second)...> type;
+};
+
+//! @brief the sequence 0 ... N - 1, built from two halves to keep the instantiation depth logarithmic
+template <unsigned N> struct CyclicMakeIndices {
+    typedef typename CyclicConcat<typename CyclicMakeIndices<N / 2>::type,
+                                  typename CyclicMakeIndices<N - N / 2>::type>::type type;
+};
+
+template <> struct CyclicMakeIndices<0> {
+    typedef CyclicIndices<> type;
+};
+
+template <> struct CyclicMakeIndices<1> {
+    typedef CyclicIndices<0> type;
+};
+
+//! @brief the dispatch table, one function per minor frame, in flash on AVR
+template <typename Executive, typename Indices> struct CyclicTable;
+
+template <typename Executive, unsigned... Indices> struct CyclicTable<Executive, CyclicIndices<Indices...> > {
+    static const typename Executive::Frame_t table[sizeof...(Indices)];
+};
+
+template <typename Executive, unsigned... Indices>
+const typename Executive::Frame_t
+    CyclicTable<Executive, CyclicIndices<Indices...> >::table[sizeof...(Indices)] PROGMEM = {
+        &Executive::template frame<Indices>...};
+
+//! @endcond
+
+//!
+//! @brief cyclic executive for a fixed set of harmonic tasks
+//! @details The schedule is computed at compile time: the major frame is the least common multiple of all
+//!          periods and is divided into minor frames. For each minor frame a function calling the due tasks
+//!          is generated. The compilation fails if the periods are not harmonic (each period divides the next
+//!          longer one), if a period is not a multiple of the minor frame or if the budgets of the tasks due in
+//!          one minor frame exceed its length.
+//!          At runtime a minor frame costs one table lookup and one indirect call.
+//!
+//!          @code
+//!          void fast(void);
+//!          void slow(void);
+//!
+//!          CyclicExecutive<1, CyclicTask<fast, 1, 200>, CyclicTask<slow, 10, 500> > executive;
+//!          Intervall tick(1);
+//!
+//!          void loop() {
+//!              executive.run(tick);
+//!          }
+//!          @endcode
+//!
+//! @tparam MinorFrame length of a minor frame in milliseconds
+//! @tparam Tasks list of CyclicTask
+//!
+template <uint16_t MinorFrame, typename... Tasks> class CyclicExecutive {
+    //! @cond
+    typedef CyclicTaskSet<Tasks...> Set;
+    //! @endcond
+
+  public:
+    typedef void (*Frame_t)(void); //!< function executing a minor frame
+
+    //! @brief return the length of the major frame in milliseconds
+    static constexpr uint32_t getMajorFrame(void) {
+        return Set::hyperPeriod();
+    }
+
+    //! @brief return the number of minor frames per major frame
+    static constexpr uint32_t getFrames(void) {
+        return Set::hyperPeriod() / MinorFrame;
+    }
+
+    //! @brief return the highest sum of budgets in a minor frame in microseconds
+    static constexpr uint32_t getWorstCaseLoad(void) {
+        return cyclicMaxLoad<Set>(0, getFrames(), MinorFrame);
+    }
+
+    static_assert(MinorFrame > 0, "minor frame must not be 0");
+    static_assert(sizeof...(Tasks) > 0, "no tasks");
+    static_assert(Set::isHarmonic(), "each period must divide the next longer one");
+    static_assert(Set::isMultipleOf(MinorFrame), "all periods must be multiples of the minor frame");
+    static_assert(getWorstCaseLoad() <= MinorFrame * 1000UL, "tasks exceed the budget of a minor frame");
+
+    //!
+    //! @brief Construct a new Cyclic Executive object
+    //!
+    CyclicExecutive() {
+        current = 0;
+    }
+
+    //!
+    //! @brief execute the current minor frame and advance to the next one
+    //!
+    void dispatch(void) {
+#ifdef ARDUINO_ARCH_AVR
+        Frame_t func = (Frame_t)pgm_read_word(&Table::table[current]);
+#else
+        Frame_t func = Table::table[current];
+#endif
+
+        func();
+
+        if (++current >= getFrames())
+            current = 0;
+    }
+
+    //!
+    //! @brief execute the current minor frame and wait for the end of the minor frame
+    //! @pre tick has the period MinorFrame and begin() has been called
+    //!
+    //! @param tick the intervall of the minor frames
+    //! @return Intervall::Result_t result of tick.wait(), Overflow indicates a budget violation
+    //!
+    Intervall::Result_t run(Intervall& tick) {
+        dispatch();
+
+        return tick.wait();
+    }
+
+    //!
+    //! @brief return the index of the next minor frame
+    //!
+    //! @return uint16_t
+    //!
+    uint16_t getFrame(void) {
+        return current;
+    }
+
+  private:
+    //! @cond
+    typedef CyclicTable<CyclicExecutive, typename CyclicMakeIndices<getFrames()>::type> Table;
+
+    template <typename, typename> friend struct CyclicTable;
+
+    //! @brief call all tasks due in minor frame Index
+    template <unsigned Index> static void frame(void) {
+        Set::template dispatch<Index * MinorFrame>();
+    }
+    //! @endcond
+
+    uint16_t current; //!< index of the next minor frame
+};
@@ -52,6 +52,17 @@
 //! @endcond
 #endif
 
+//!
+//! @brief printf conversion of a `const __FlashStringHelper*`, AVR and ESP8266 read program memory with %S
+//! @details Pass the argument as `const char*`, e.g.
+//!          `PRINT_INFO("name: " RR_FLASH_FMT, reinterpret_cast<const char*>(name))`.
+//!
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_ESP8266)
+    #define RR_FLASH_FMT "%S"
+#else
+    #define RR_FLASH_FMT "%s"
+#endif
+
 //! date and time when this module was built
 #define BUILD __DATE__ " " __TIME__
 
@@ -120,6 +131,7 @@ class DebugUtils {
     //!
     //! @param columns array, which contains ascending tab position in absolute columns
     //! @param count number of tabs
+    //! @note Each message starts with its location, the first tab should be placed behind it.
     //!
     void setTabs(unsigned columns[], unsigned count);
 
@@ -0,0 +1,416 @@
+//!
+//! @file rr_HardwareIntervall.cpp
+//! @author M. Nickels
+//! @brief periodic execution triggered by a hardware timer interrupt
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_DebugUtils.h"
+#include "rr_HardwareIntervall.h"
+
+#if !defined(ARDUINO) && !defined(RR_VIRTUAL_CLOCK)
+    #include <chrono>
+#endif
+
+HardwareIntervall::HardwareIntervall(Period_t newPeriod) {
+    period   = newPeriod;
+    running  = false;
+    callback = NULL;
+    context  = NULL;
+    ticks    = 0;
+    handled  = 0;
+    missed   = 0;
+
+#ifdef WITH_INTERVALL_TRACE
+    id = Intervall::nextId++;
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+    timer = NULL;
+#elif !defined(ARDUINO) && !defined(RR_VIRTUAL_CLOCK)
+    stop = false;
+#endif
+
+#ifndef WITHOUT_INTERVALL_STATS
+    resetStatistics();
+#endif
+}
+
+HardwareIntervall::~HardwareIntervall() {
+    end();
+}
+
+HardwareIntervall::Period_t HardwareIntervall::getPeriod(void) {
+    return period;
+}
+
+bool HardwareIntervall::begin(void) {
+    end();
+
+    handled = ticks;
+    missed  = 0;
+
+#ifndef WITHOUT_INTERVALL_STATS
+    lastReturn = 0;
+#endif
+
+    running = startTimer();
+
+    if (!running)
+        PRINT_ERROR("HardwareIntervall: no timer available for a period of %lu us", period);
+
+    return running;
+}
+
+void HardwareIntervall::end(void) {
+    if (running) {
+        stopTimer();
+        running = false;
+    }
+}
+
+void HardwareIntervall::setCallback(TickCallback_t newCallback, void* newContext) {
+    // the interrupt must not see a new callback with an old context
+    if (running)
+        stopTimer();
+
+    callback = newCallback;
+    context  = newContext;
+
+    if (running)
+        running = startTimer();
+}
+
+void HardwareIntervall::onTimer(void) {
+    ticks++;
+
+    if (callback)
+        callback(context);
+}
+
+bool HardwareIntervall::takeTick(void) {
+    uint8_t pending = ticks - handled;
+
+    if (pending == 0)
+        return false;
+
+    missed += pending - 1;
+    handled += pending;
+
+    return true;
+}
+
+bool HardwareIntervall::isPeriodOver(void) {
+    return takeTick();
+}
+
+Intervall::Result_t HardwareIntervall::wait(bool (*userFunc)(void)) {
+    Intervall::Result_t result = Intervall::Success;
+
+    if (!running) {
+        PRINT_ERROR("HardwareIntervall not running. Call begin() before wait()", NULL);
+        return Intervall::Failure;
+    }
+
+#ifndef WITHOUT_INTERVALL_STATS
+    if (lastReturn != 0)
+        statistics.add(now() - lastReturn);
+#endif
+
+    if (takeTick()) {
+        // the interrupt came before wait() was called
+        reportOverflow();
+        result = Intervall::Overflow;
+    }
+    else {
+        while (!takeTick()) {
+            if (userFunc != NULL && userFunc()) {
+                result = Intervall::Abort;
+                break;
+            }
+
+#if defined(ARDUINO) || defined(RR_VIRTUAL_CLOCK)
+            RR_YIELD();
+#else
+            std::this_thread::yield();
+#endif
+        }
+    }
+
+#ifndef WITHOUT_INTERVALL_STATS
+    unsigned long current = now();
+
+    if (lastReturn != 0 && result == Intervall::Success) {
+        Period_t actual    = current - lastReturn;
+        Period_t deviation = actual > period ? actual - period : period - actual;
+
+        if (deviation > maxJitter)
+            maxJitter = deviation;
+    }
+
+    // the next busy time starts now, 0 is reserved for "no return yet"
+    lastReturn = current ? current : 1;
+#endif
+
+    return result;
+}
+
+void HardwareIntervall::reportOverflow(void) {
+#ifdef WITH_INTERVALL_TRACE
+    const Period_t          limit = (Intervall::Period_t)-1;
+    Intervall::TraceEvent_t event;
+    Period_t                duration = period;
+
+    #ifndef WITHOUT_INTERVALL_STATS
+    // busy time since the last return of wait()
+    if (lastReturn != 0)
+        duration = now() - lastReturn;
+    #endif
+
+    event.timeStamp = RR_MILLIS();
+    event.period    = period < limit ? period : limit;
+    event.duration  = duration < limit ? duration : limit;
+    event.id        = id;
+
+    // the oldest event is dropped
+    Intervall::trace.pushOverwrite(event);
+#else
+    PRINT_WARNING("HardwareIntervall overflow. Intervall: %lu us", period);
+#endif
+}
+
+unsigned long HardwareIntervall::getMissed(void) {
+    return missed;
+}
+
+#ifndef WITHOUT_INTERVALL_STATS
+
+HardwareIntervall::Period_t HardwareIntervall::getMinPeriod(void) {
+    return statistics.getMin();
+}
+
+HardwareIntervall::Period_t HardwareIntervall::getMaxPeriod(void) {
+    return statistics.getMax();
+}
+
+HardwareIntervall::Period_t HardwareIntervall::getAvgPeriod(void) {
+    return statistics.getMean();
+}
+
+HardwareIntervall::Period_t HardwareIntervall::getStdDevPeriod(void) {
+    return statistics.getStdDev();
+}
+
+HardwareIntervall::Period_t HardwareIntervall::getMaxJitter(void) {
+    return maxJitter;
+}
+
+void HardwareIntervall::resetStatistics(void) {
+    statistics.reset();
+
+    maxJitter = 0;
+}
+
+void HardwareIntervall::printStatistics(void) {
+    PRINT_INFO("HardwareIntervall statistics: Period: %lu us  Min: %lu  Max: %lu  Average: %lu  StdDev: %lu", period,
+               getMinPeriod(), getMaxPeriod(), getAvgPeriod(), getStdDevPeriod());
+    PRINT_INFO("HardwareIntervall timing: Jitter: %lu us  Missed: %lu", getMaxJitter(), getMissed());
+}
+
+#endif // WITHOUT_INTERVALL_STATS
+
+#if defined(ARDUINO) || defined(RR_VIRTUAL_CLOCK)
+
+unsigned long HardwareIntervall::now(void) {
+    return RR_MICROS();
+}
+
+#else
+
+unsigned long HardwareIntervall::now(void) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#endif
+
+#if defined(ARDUINO_ARCH_AVR)
+
+HardwareIntervall* HardwareIntervall::active = NULL;
+
+//! @brief dispatch the Timer1 interrupt to the active instance
+void hardwareIntervallTimer1(void) {
+    if (HardwareIntervall::active)
+        HardwareIntervall::active->onTimer();
+}
+
+ISR(TIMER1_COMPA_vect) {
+    hardwareIntervallTimer1();
+}
+
+bool HardwareIntervall::startTimer(void) {
+    static const uint16_t prescalers[] = {1, 8, 64, 256, 1024};
+    static const uint8_t  clockBits[]  = {_BV(CS10), _BV(CS11), _BV(CS11) | _BV(CS10), _BV(CS12),
+                                          _BV(CS12) | _BV(CS10)};
+
+    if (active != NULL && active != this)
+        return false;
+
+    // Timer1 is owned by someone else, e.g. CycleCounter or Servo
+    if (TIMSK1 & (_BV(TOIE1) | _BV(OCIE1B) | _BV(ICIE1)))
+        return false;
+
+    // select the smallest prescaler, which fits the period into the 16 bit compare register
+    for (uint8_t index = 0; index < sizeof(prescalers) / sizeof(prescalers[0]); index++) {
+        unsigned long counts = (F_CPU / 1000000UL) * period / prescalers[index];
+
+        if (counts >= 1 && counts <= 65536UL) {
+            noInterrupts();
+
+            TCCR1A = 0;
+            TCCR1B = _BV(WGM12) | clockBits[index];
+            TCNT1  = 0;
+            OCR1A  = counts - 1;
+            TIFR1  = _BV(OCF1A);
+            TIMSK1 |= _BV(OCIE1A);
+            active = this;
+
+            interrupts();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void HardwareIntervall::stopTimer(void) {
+    noInterrupts();
+
+    TIMSK1 &= ~_BV(OCIE1A);
+    TCCR1B = 0;
+    active = NULL;
+
+    interrupts();
+}
+
+#elif defined(ARDUINO_ARCH_ESP32)
+
+void HardwareIntervall::timerCallback(void* self) {
+    ((HardwareIntervall*)self)->onTimer();
+}
+
+bool HardwareIntervall::startTimer(void) {
+    esp_timer_create_args_t args = {};
+
+    args.callback = timerCallback;
+    args.arg      = this;
+    args.name     = "HardwareIntervall";
+
+    if (esp_timer_create(&args, &timer) != ESP_OK)
+        return false;
+
+    if (esp_timer_start_periodic(timer, period) != ESP_OK) {
+        esp_timer_delete(timer);
+        timer = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void HardwareIntervall::stopTimer(void) {
+    esp_timer_stop(timer);
+    esp_timer_delete(timer);
+    timer = NULL;
+}
+
+#elif defined(ARDUINO_ARCH_RP2040)
+
+bool HardwareIntervall::timerCallback(repeating_timer_t* timer) {
+    ((HardwareIntervall*)timer->user_data)->onTimer();
+
+    // keep repeating
+    return true;
+}
+
+bool HardwareIntervall::startTimer(void) {
+    // a negative delay means the time between the starts of the callbacks, so the period does not drift
+    return add_repeating_timer_us(-(int64_t)period, timerCallback, this, &timer);
+}
+
+void HardwareIntervall::stopTimer(void) {
+    cancel_repeating_timer(&timer);
+}
+
+#elif !defined(ARDUINO) && defined(RR_VIRTUAL_CLOCK)
+
+void HardwareIntervall::timerCallback(void* self) {
+    ((HardwareIntervall*)self)->onTimer();
+}
+
+bool HardwareIntervall::startTimer(void) {
+    if (period == 0)
+        return false;
+
+    timer.start(period, timerCallback, this);
+
+    return true;
+}
+
+void HardwareIntervall::stopTimer(void) {
+    timer.stop();
+}
+
+#elif !defined(ARDUINO)
+
+void HardwareIntervall::timerThread(HardwareIntervall* self) {
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+
+    while (!self->stop) {
+        next += std::chrono::microseconds(self->period);
+        std::this_thread::sleep_until(next);
+
+        if (!self->stop)
+            self->onTimer();
+    }
+}
+
+bool HardwareIntervall::startTimer(void) {
+    if (period == 0)
+        return false;
+
+    stop   = false;
+    thread = std::thread(timerThread, this);
+
+    return true;
+}
+
+void HardwareIntervall::stopTimer(void) {
+    stop = true;
+
+    if (thread.joinable())
+        thread.join();
+}
+
+#else
+
+bool HardwareIntervall::startTimer(void) {
+    // no timer support on this platform
+    return false;
+}
+
+void HardwareIntervall::stopTimer(void) {
+}
+
+#endif
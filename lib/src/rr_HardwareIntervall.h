@@ -0,0 +1,265 @@
+//!
+//! @file rr_HardwareIntervall.h
+//! @author M. Nickels
+//! @brief periodic execution triggered by a hardware timer interrupt
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_Intervall.h"
+#ifndef WITHOUT_INTERVALL_STATS
+    #include "rr_Statistics.h"
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+    #include <esp_timer.h>
+#elif defined(ARDUINO_ARCH_RP2040)
+    #include <pico/time.h>
+#elif !defined(ARDUINO)
+    #include <atomic>
+    #include <thread>
+#endif
+
+//!
+//! @brief periodic execution triggered by a hardware timer
+//! @details In contrast to Intervall the end of a period is not detected by polling the clock, but signalled by
+//!          a timer interrupt. wait() returns within microseconds after the interrupt, independent of how long
+//!          a pass of loop() takes, and the periods do not drift.
+//!
+//!          | Platform | Timer                                                       | Instances |
+//!          | -------- | ----------------------------------------------------------- | --------- |
+//!          | AVR      | Timer1 in CTC mode (conflicts with Servo, analogWrite 9/10) | 1         |
+//!          | ESP32    | esp_timer                                                   | any       |
+//!          | RP2040   | repeating timer of the hardware alarm pool                  | any       |
+//!          | native   | VirtualTimer with RR_VIRTUAL_CLOCK, otherwise a thread      | any       |
+//!
+//!          On other platforms begin() fails. On AVR begin() fails as well, if another Timer1 interrupt is in use,
+//!          e.g. by CycleCounter.
+//!
+//!          An overflow of wait() is recorded in the overrun trace of Intervall with -DWITH_INTERVALL_TRACE.
+//!
+class HardwareIntervall {
+
+  public:
+    typedef unsigned long Period_t; //!< period in microseconds
+
+    typedef void (*TickCallback_t)(void* context); //!< called in interrupt context at the end of each period
+
+    //!
+    //! @brief Construct a new Hardware Intervall object
+    //!
+    //! @param newPeriod period in microseconds
+    //!
+    HardwareIntervall(Period_t newPeriod);
+
+    //!
+    //! @brief Destroy the Hardware Intervall object, the timer is stopped
+    //!
+    ~HardwareIntervall();
+
+    //!
+    //! @brief return the period length
+    //!
+    //! @return HardwareIntervall::Period_t period in microseconds
+    //!
+    Period_t getPeriod(void);
+
+    //!
+    //! @brief start the timer
+    //! @details a running timer is restarted
+    //!
+    //! @return true if the timer has been started, false if the period is not supported or the timer is in use
+    //!
+    bool begin(void);
+
+    //!
+    //! @brief stop the timer
+    //!
+    void end(void);
+
+    //!
+    //! @brief set a function, which is called by the timer interrupt at the end of each period
+    //! @details e.g. to release a task. The function is called in interrupt context and must be short.
+    //!
+    //! @param callback the function, NULL to remove it
+    //! @param context parameter of the function
+    //!
+    void setCallback(TickCallback_t callback, void* context = NULL);
+
+    //!
+    //! @brief non blocking check for the end of the period
+    //! @details returns true once for every interrupt since the last call of isPeriodOver() or wait()
+    //!
+    //! @return true if the period is over
+    //!
+    bool isPeriodOver(void);
+
+    //!
+    //! @brief wait for the interrupt at the end of the period
+    //! @pre begin() has been called
+    //!
+    //! @param userFunc if not null and this functions returns true, the wait is aborted
+    //! @return Intervall::Result_t Success, Abort, Overflow if at least one interrupt had been missed or
+    //!         Failure if the timer is not running
+    //!
+    Intervall::Result_t wait(bool (*userFunc)(void) = NULL);
+
+    //!
+    //! @brief return the number of interrupts missed by wait() or isPeriodOver()
+    //!
+    //! @return unsigned long
+    //!
+    unsigned long getMissed(void);
+
+#ifndef WITHOUT_INTERVALL_STATS
+    //!
+    //! @name Statistic functions
+    //! @details The statistics record the time from the return of wait() to its next call (busy time) and the
+    //!          deviation of the achieved period from the nominal one (jitter).
+    //! @{
+
+    //!
+    //! @brief return the shortest busy time
+    //!
+    //! @return HardwareIntervall::Period_t microseconds
+    //!
+    Period_t getMinPeriod(void);
+
+    //!
+    //! @brief return the longest busy time
+    //!
+    //! @return HardwareIntervall::Period_t microseconds
+    //!
+    Period_t getMaxPeriod(void);
+
+    //!
+    //! @brief return the average busy time
+    //!
+    //! @return HardwareIntervall::Period_t microseconds
+    //!
+    Period_t getAvgPeriod(void);
+
+    //!
+    //! @brief return the standard deviation of the busy time
+    //!
+    //! @return HardwareIntervall::Period_t microseconds
+    //!
+    Period_t getStdDevPeriod(void);
+
+    //!
+    //! @brief return the largest deviation of the time between two returns of wait() from the period
+    //!
+    //! @return HardwareIntervall::Period_t microseconds
+    //!
+    Period_t getMaxJitter(void);
+
+    //!
+    //! @brief reset statistics
+    //!
+    void resetStatistics(void);
+
+    //!
+    //! @brief show all statistics
+    //!
+    void printStatistics(void);
+    //! @}
+#endif
+
+  private:
+    //!
+    //! @brief called by the timer at the end of each period
+    //!
+    void onTimer(void);
+
+    //!
+    //! @brief start the platform timer
+    //!
+    //! @return true on success
+    //!
+    bool startTimer(void);
+
+    //!
+    //! @brief stop the platform timer
+    //!
+    void stopTimer(void);
+
+    //!
+    //! @brief take one pending interrupt and update statistics and missed interrupts
+    //!
+    //! @return true if there was a pending interrupt
+    //!
+    bool takeTick(void);
+
+    //!
+    //! @brief record an overflow of wait()
+    //!
+    void reportOverflow(void);
+
+    //!
+    //! @brief current time for the statistics
+    //!
+    //! @return unsigned long microseconds
+    //!
+    static unsigned long now(void);
+
+    Period_t       period;   //!< period in microseconds
+    bool           running;  //!< timer has been started
+    TickCallback_t callback; //!< called in interrupt context
+    void*          context;  //!< parameter of callback
+
+#ifdef ARDUINO
+    typedef volatile uint8_t Counter_t; //!< written by the interrupt
+#else
+    typedef std::atomic<uint8_t> Counter_t; //!< written by the timer thread
+#endif
+
+    // The interrupt only writes ticks, the main program only writes handled. Both are single bytes, so
+    // they can be read without disabling interrupts.
+    Counter_t     ticks;   //!< number of interrupts (modulo 256)
+    uint8_t       handled; //!< number of consumed interrupts (modulo 256)
+    unsigned long missed;  //!< number of missed interrupts
+
+#ifdef WITH_INTERVALL_TRACE
+    uint8_t id; //!< id in trace events, shared with Intervall
+#endif
+
+#ifndef WITHOUT_INTERVALL_STATS
+    RunningStatistics statistics; //!< busy time
+    unsigned long     lastReturn; //!< time of the last return of wait()
+    Period_t          maxJitter;  //!< largest deviation from the period
+#endif
+
+#if defined(ARDUINO_ARCH_AVR)
+    friend void hardwareIntervallTimer1(void);
+
+    static HardwareIntervall* active; //!< instance using Timer1
+#elif defined(ARDUINO_ARCH_ESP32)
+    esp_timer_handle_t timer; //!< the esp timer
+
+    static void timerCallback(void* self);
+#elif defined(ARDUINO_ARCH_RP2040)
+    repeating_timer_t timer; //!< the repeating timer
+
+    static bool timerCallback(repeating_timer_t* timer);
+#elif !defined(ARDUINO) && defined(RR_VIRTUAL_CLOCK)
+    VirtualTimer timer; //!< timer on the virtual time
+
+    static void timerCallback(void* self);
+#elif !defined(ARDUINO)
+    std::thread       thread; //!< thread simulating the timer
+    std::atomic<bool> stop;   //!< request to terminate the thread
+
+    static void timerThread(HardwareIntervall* self);
+#endif
+};
@@ -0,0 +1,212 @@
+//!
+//! @file rr_I2CDevices.cpp
+//! @author M. Nickels
+//! @brief identification of I2C devices by address and chip ID
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Common.h"
+#include "rr_I2CDevices.h"
+
+//!
+//! @brief entry of the address table
+//!
+struct I2CDeviceName {
+    uint8_t     address; //!< I2C address
+    const char* names;   //!< candidates in flash
+};
+
+//! @cond
+// candidates per address
+static const char accel[] PROGMEM      = "LIS3DH, LIS2DH12, MCP9808";
+static const char adxl[] PROGMEM       = "ADXL345, MMA8451";
+static const char ak8963[] PROGMEM     = "AK8963";
+static const char ads1115[] PROGMEM    = "ADS1115, TMP102, LM75";
+static const char ads1115pcf[] PROGMEM = "ADS1115, PCF8591, TMP102, LM75";
+static const char adxlEeprom[] PROGMEM = "ADXL345, AT24Cxx";
+static const char aht[] PROGMEM        = "AHT10, AHT20, PCF8574A, FT6206";
+static const char apds[] PROGMEM       = "APDS-9960, TSL2561, PCF8574A";
+static const char bh1750[] PROGMEM     = "BH1750, PCF8574, MCP23017";
+static const char bme[] PROGMEM        = "BMP280, BME280, BME680, MS5611";
+static const char bmp[] PROGMEM        = "BMP180, BMP280, BME280, BME680, MS5611";
+static const char ccs811[] PROGMEM     = "CCS811, MLX90614, MPR121";
+static const char ccs811b[] PROGMEM    = "CCS811, MPR121";
+static const char eeprom[] PROGMEM     = "AT24Cxx";
+static const char eepromRtc[] PROGMEM  = "AT24C32 (RTC module), AT24Cxx";
+static const char hmc5883[] PROGMEM    = "HMC5883L, LSM303 (mag)";
+static const char ina219[] PROGMEM     = "INA219, HTU21D, Si7021, PCA9685";
+static const char lcdA[] PROGMEM       = "PCF8574A (LCD)";
+static const char lcd[] PROGMEM        = "PCF8574 (LCD), MCP23017";
+static const char lsm6[] PROGMEM       = "LSM6DS3, LSM6DSOX";
+static const char mcp4725[] PROGMEM    = "MCP4725, Si5351, ATECC608";
+static const char mpu[] PROGMEM        = "MPU6050, MPU9250, ICM-20948, DS3231, DS1307";
+static const char mpuAlt[] PROGMEM     = "MPU6050, MPU9250, ICM-20948";
+static const char oled[] PROGMEM       = "SSD1306, SH1106";
+static const char pcf8574[] PROGMEM    = "PCF8574, MCP23017";
+static const char pca9548[] PROGMEM    = "TCA9548A, HT16K33";
+static const char qmc5883[] PROGMEM    = "QMC5883L";
+static const char scd4x[] PROGMEM      = "SCD40, SCD41, MCP4725";
+static const char sht3x[] PROGMEM      = "SHT3x";
+static const char am2320[] PROGMEM     = "AM2320, BH1750";
+static const char tof[] PROGMEM        = "VL53L0X, TSL2561, TCS34725";
+static const char veml[] PROGMEM       = "VEML7700, VEML6075";
+
+// chip names
+static const char adxl345[] PROGMEM  = "ADXL345";
+static const char bmp180[] PROGMEM   = "BMP180";
+static const char bmp280[] PROGMEM   = "BMP280";
+static const char bme280[] PROGMEM   = "BME280";
+static const char bme680[] PROGMEM   = "BME680";
+static const char icm20948[] PROGMEM = "ICM-20948";
+static const char lis3dh[] PROGMEM   = "LIS3DH";
+static const char lsm6ds3[] PROGMEM  = "LSM6DS3";
+static const char lsm6dsox[] PROGMEM = "LSM6DSOX";
+static const char mma8451[] PROGMEM  = "MMA8451";
+static const char mpu6050[] PROGMEM  = "MPU6050";
+static const char mpu6500[] PROGMEM  = "MPU6500";
+static const char mpu9250[] PROGMEM  = "MPU9250";
+//! @endcond
+
+//! @brief candidates sorted by address
+static const I2CDeviceName deviceNames[] PROGMEM = {
+    {0x0C,     ak8963},
+    {0x0D,    qmc5883},
+    {0x10,       veml},
+    {0x18,      accel},
+    {0x19,      accel},
+    {0x1D,       adxl},
+    {0x1E,    hmc5883},
+    {0x20,    pcf8574},
+    {0x21,    pcf8574},
+    {0x22,    pcf8574},
+    {0x23,     bh1750},
+    {0x24,    pcf8574},
+    {0x25,    pcf8574},
+    {0x26,    pcf8574},
+    {0x27,        lcd},
+    {0x29,        tof},
+    {0x38,        aht},
+    {0x39,       apds},
+    {0x3C,       oled},
+    {0x3D,       oled},
+    {0x3F,       lcdA},
+    {0x40,     ina219},
+    {0x44,      sht3x},
+    {0x45,      sht3x},
+    {0x48, ads1115pcf},
+    {0x49,    ads1115},
+    {0x4A,    ads1115},
+    {0x4B,    ads1115},
+    {0x50,     eeprom},
+    {0x51,     eeprom},
+    {0x52,     eeprom},
+    {0x53, adxlEeprom},
+    {0x54,     eeprom},
+    {0x55,     eeprom},
+    {0x56,     eeprom},
+    {0x57,  eepromRtc},
+    {0x5A,     ccs811},
+    {0x5B,    ccs811b},
+    {0x5C,     am2320},
+    {0x60,    mcp4725},
+    {0x62,      scd4x},
+    {0x68,        mpu},
+    {0x69,     mpuAlt},
+    {0x6A,       lsm6},
+    {0x6B,       lsm6},
+    {0x70,    pca9548},
+    {0x76,        bme},
+    {0x77,        bmp},
+};
+
+//! @brief chip ID registers sorted by address, entries of an address sorted by register
+static const I2CChipId chipIds[] PROGMEM = {
+    {0x18, 0x0F, 0x33,   lis3dh},
+    {0x19, 0x0F, 0x33,   lis3dh},
+    {0x1D, 0x00, 0xE5,  adxl345},
+    {0x1D, 0x0D, 0x1A,  mma8451},
+    {0x53, 0x00, 0xE5,  adxl345},
+    {0x68, 0x00, 0xEA, icm20948},
+    {0x68, 0x75, 0x68,  mpu6050},
+    {0x68, 0x75, 0x70,  mpu6500},
+    {0x68, 0x75, 0x71,  mpu9250},
+    {0x69, 0x00, 0xEA, icm20948},
+    {0x69, 0x75, 0x68,  mpu6050},
+    {0x69, 0x75, 0x70,  mpu6500},
+    {0x69, 0x75, 0x71,  mpu9250},
+    {0x6A, 0x0F, 0x69,  lsm6ds3},
+    {0x6A, 0x0F, 0x6C, lsm6dsox},
+    {0x6B, 0x0F, 0x69,  lsm6ds3},
+    {0x6B, 0x0F, 0x6C, lsm6dsox},
+    {0x76, 0xD0, 0x58,   bmp280},
+    {0x76, 0xD0, 0x60,   bme280},
+    {0x76, 0xD0, 0x61,   bme680},
+    {0x77, 0xD0, 0x55,   bmp180},
+    {0x77, 0xD0, 0x58,   bmp280},
+    {0x77, 0xD0, 0x60,   bme280},
+    {0x77, 0xD0, 0x61,   bme680},
+};
+
+const __FlashStringHelper* lookupI2C(uint8_t address) {
+    uint8_t low  = 0;
+    uint8_t high = arraySize(deviceNames);
+
+    while (low < high) {
+        uint8_t middle = (low + high) / 2;
+        uint8_t found  = pgm_read_byte(&deviceNames[middle].address);
+
+        if (found == address) {
+            I2CDeviceName entry;
+
+            memcpy_P(&entry, &deviceNames[middle], sizeof(entry));
+
+            return (const __FlashStringHelper*)entry.names;
+        }
+
+        if (found < address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return NULL;
+}
+
+uint8_t findI2CChipId(uint8_t address) {
+    uint8_t low  = 0;
+    uint8_t high = arraySize(chipIds);
+
+    // first entry, which is not less than address
+    while (low < high) {
+        uint8_t middle = (low + high) / 2;
+
+        if (pgm_read_byte(&chipIds[middle].address) < address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+bool getI2CChipId(uint8_t index, I2CChipId& entry) {
+    if (index >= arraySize(chipIds))
+        return false;
+
+    memcpy_P(&entry, &chipIds[index], sizeof(entry));
+
+    return true;
+}
+
+uint8_t getI2CChipIds(void) {
+    return arraySize(chipIds);
+}
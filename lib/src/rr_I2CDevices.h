@@ -0,0 +1,120 @@
+//!
+//! @file rr_I2CDevices.h
+//! @author M. Nickels
+//! @brief identification of I2C devices by address and chip ID
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_DebugUtils.h"
+#include "rr_I2CRegisters.h"
+#include "rr_scanI2C.h"
+
+//!
+//! @brief entry of the chip ID table
+//! @details A device is identified, if the register reg of the device at address contains id.
+//!
+struct I2CChipId {
+    uint8_t     address; //!< I2C address
+    uint8_t     reg;     //!< chip ID register
+    uint8_t     id;      //!< expected content of the register
+    const char* name;    //!< device name in flash
+};
+
+//!
+//! @brief look up the devices, which are commonly found at an address
+//! @details The table is sorted by address and stored in flash, the lookup is a binary search without RAM.
+//!
+//! @param address I2C address
+//! @return const __FlashStringHelper* candidates separated by comma, NULL if the address is unknown
+//!
+const __FlashStringHelper* lookupI2C(uint8_t address);
+
+//!
+//! @brief find the first chip ID entry of an address
+//!
+//! @param address I2C address
+//! @return uint8_t index of the entry, getI2CChipIds() if there is none
+//!
+uint8_t findI2CChipId(uint8_t address);
+
+//!
+//! @brief copy an entry of the chip ID table from flash
+//!
+//! @param index index of the entry
+//! @param entry receives the entry
+//! @return true if the index is valid
+//!
+bool getI2CChipId(uint8_t index, I2CChipId& entry);
+
+//!
+//! @brief return the number of entries of the chip ID table
+//!
+//! @return uint8_t
+//!
+uint8_t getI2CChipIds(void);
+
+//!
+//! @brief identify the device at an address by its chip ID register
+//! @details The chip ID registers of all candidates of the address are read. If no ID matches, the result of
+//!          lookupI2C() is returned. Reading a register might have side effects on unknown devices, therefore
+//!          the identification is optional and only done on request.
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @param bus the bus
+//! @param address I2C address
+//! @return const __FlashStringHelper* device name, candidates or NULL
+//!
+template <class Bus> const __FlashStringHelper* identifyI2C(Bus& bus, uint8_t address) {
+    I2CChipId entry;
+    bool      valid = false;
+    uint8_t   value = 0;
+    uint8_t   reg   = 0;
+
+    for (uint8_t index = findI2CChipId(address); getI2CChipId(index, entry) && entry.address == address; index++) {
+        // candidates with the same ID register share one read
+        if (!valid || entry.reg != reg) {
+            reg   = entry.reg;
+            valid = readI2CRegister(bus, address, reg, value);
+        }
+
+        if (valid && value == entry.id)
+            return (const __FlashStringHelper*)entry.name;
+    }
+
+    return lookupI2C(address);
+}
+
+//!
+//! @brief print the devices of a bitmap with the names identified by identifyI2C()
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @param bus the bus
+//! @param map the bitmap
+//!
+template <class Bus> void printI2C(Bus& bus, const I2CMap_t map) {
+    uint8_t nDevices = 0;
+
+    for (uint8_t address = 0; address < 128; address++) {
+        if (isI2CPresent(map, address)) {
+            const __FlashStringHelper* name = identifyI2C(bus, address);
+
+            PRINT_INFO("I2C device 0x%x: " RR_FLASH_FMT, address,
+                       reinterpret_cast<const char*>(name != NULL ? name : F("unknown")));
+            nDevices++;
+        }
+    }
+
+    if (nDevices == 0)
+        PRINT_WARNING("No I2C devices found", NULL);
+}
@@ -0,0 +1,61 @@
+//!
+//! @file rr_I2CHealth.cpp
+//! @author M. Nickels
+//! @brief health metrics of an I2C bus and recovery of a stuck bus
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_I2CHealth.h"
+
+//! @brief half period of the recovery clock in microseconds
+#define I2C_RECOVERY_DELAY 5
+
+//!
+//! @brief drive an open drain line low
+//!
+//! @param pin the pin
+//!
+static void pullLow(uint8_t pin) {
+    // the output register is set before the direction, so the line is never driven high
+    digitalWrite(pin, LOW);
+    pinMode(pin, OUTPUT);
+    delayMicroseconds(I2C_RECOVERY_DELAY);
+}
+
+//!
+//! @brief release an open drain line
+//!
+//! @param pin the pin
+//!
+static void release(uint8_t pin) {
+    pinMode(pin, INPUT_PULLUP);
+    delayMicroseconds(I2C_RECOVERY_DELAY);
+}
+
+bool recoverI2C(uint8_t sda, uint8_t scl) {
+    release(sda);
+    release(scl);
+
+    // a device, which holds SDA low, releases it after at most 9 clocks
+    for (uint8_t clocks = 0; clocks < 9 && digitalRead(sda) == LOW; clocks++) {
+        pullLow(scl);
+        release(scl);
+    }
+
+    // STOP condition: SDA rises while SCL is high
+    pullLow(scl);
+    pullLow(sda);
+    release(scl);
+    release(sda);
+
+    return digitalRead(sda) == HIGH && digitalRead(scl) == HIGH;
+}
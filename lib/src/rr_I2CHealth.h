@@ -0,0 +1,439 @@
+//!
+//! @file rr_I2CHealth.h
+//! @author M. Nickels
+//! @brief health metrics of an I2C bus and recovery of a stuck bus
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_Containers.h"
+#include "rr_DebugUtils.h"
+#include "rr_Statistics.h"
+
+//!
+//! @brief release a bus, which is blocked by a device holding SDA low
+//! @details SCL is clocked until SDA is released, at most 9 times, followed by a STOP condition. The pins are
+//!          driven as open drain outputs at about 100 kHz. The I2C peripheral must not use the pins, call
+//!          Wire.end() before and Wire.begin() afterwards.
+//!
+//! @param sda pin of SDA
+//! @param scl pin of SCL
+//! @return true if both lines are high afterwards
+//!
+bool recoverI2C(uint8_t sda, uint8_t scl);
+
+//!
+//! @brief I2C bus with health metrics and automatic recovery
+//! @details The class has the interface of TwoWire and forwards all calls to the monitored bus. Therefore it can
+//!          be used with scanI2C(), I2CBusScanner or I2CBusInventory. The results of all transactions are
+//!          counted for the bus and for up to Devices addresses, which have acknowledged or failed. Plain NAKs
+//!          do not occupy an entry, otherwise a scan would fill the table. The latency of all transactions is
+//!          measured.
+//!
+//!          If threshold transactions in a row fail with a timeout or an error, the bus is recovered by
+//!          recoverI2C() or a function set by setRecovery().
+//!
+//!          @code
+//!          I2CHealthBus<TwoWire> bus(Wire, SDA, SCL);
+//!
+//!          scanI2C(bus, map);
+//!          bus.printStatistics();
+//!          @endcode
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @tparam Devices number of addresses with own counters
+//!
+template <class Bus, uint8_t Devices = 8> class I2CHealthBus {
+
+  public:
+    //!
+    //! @brief result of a transaction
+    //!
+    typedef enum {
+        Ack = 0, //!< success
+        Nak,     //!< NAK on address or data
+        Timeout, //!< timeout (error 5)
+        Error,   //!< other error, e.g. arbitration lost or bus error (error 1 or 4)
+        Results  //!< number of results
+    } Result_t;
+
+    //!
+    //! @brief recovery of the bus
+    //!
+    //! @param context context given to setRecovery()
+    //! @return true if the bus has been released
+    //!
+    typedef bool (*Recovery_t)(void* context);
+
+    //!
+    //! @brief Construct a new I2CHealthBus object
+    //!
+    //! @param newBus the monitored bus
+    //! @param newSda pin of SDA
+    //! @param newScl pin of SCL
+    //! @param newThreshold number of failed transactions in a row, which trigger a recovery, 0 = never
+    //!
+    I2CHealthBus(Bus& newBus, uint8_t newSda, uint8_t newScl, uint8_t newThreshold = 3) : bus(newBus) {
+        sda       = newSda;
+        scl       = newScl;
+        threshold = newThreshold;
+        clock     = 0;
+        target    = 0;
+        recovery  = NULL;
+        context   = NULL;
+
+        resetStatistics();
+    }
+
+    //!
+    //! @name configuration
+    //! @{
+
+    //!
+    //! @brief replace recoverI2C() by an own function
+    //!
+    //! @param newRecovery the function, NULL = recoverI2C()
+    //! @param newContext parameter of the function
+    //!
+    void setRecovery(Recovery_t newRecovery, void* newContext = NULL) {
+        recovery = newRecovery;
+        context  = newContext;
+    }
+
+    //!
+    //! @brief set the number of failed transactions in a row, which trigger a recovery
+    //!
+    //! @param newThreshold number of transactions, 0 = never
+    //!
+    void setThreshold(uint8_t newThreshold) {
+        threshold = newThreshold;
+    }
+
+    //!
+    //! @brief recover the bus and restart it with the last clock
+    //!
+    //! @return true if the bus has been released
+    //!
+    bool recover(void) {
+        bool released;
+
+        PRINT_WARNING("I2C bus recovery", NULL);
+
+#ifndef ARDUINO_ARCH_ESP8266
+        // the ESP8266 core drives the pins in software and has no end()
+        bus.end();
+#endif
+
+        released = recovery != NULL ? recovery(context) : recoverI2C(sda, scl);
+
+        bus.begin();
+
+        if (clock != 0)
+            bus.setClock(clock);
+
+        recoveries++;
+        failures = 0;
+
+        return released;
+    }
+
+    //! @}
+
+    //!
+    //! @name metrics
+    //! @{
+
+    //!
+    //! @brief return the number of transactions with a result
+    //!
+    //! @param result the result
+    //! @return unsigned long
+    //!
+    unsigned long getCount(Result_t result) {
+        return result < Results ? counts[result] : 0;
+    }
+
+    //!
+    //! @brief return the number of transactions of an address with a result
+    //!
+    //! @param address I2C address
+    //! @param result the result
+    //! @return uint16_t saturated, 0 if the address has no entry
+    //!
+    uint16_t getCount(uint8_t address, Result_t result) {
+        Device* device = find(address);
+
+        return device != NULL && result < Results ? device->counts[result] : 0;
+    }
+
+    //!
+    //! @brief return the longest transaction of an address
+    //!
+    //! @param address I2C address
+    //! @return uint16_t microseconds, saturated, 0 if the address has no entry
+    //!
+    uint16_t getMaxLatency(uint8_t address) {
+        Device* device = find(address);
+
+        return device != NULL ? device->maxLatency : 0;
+    }
+
+    //!
+    //! @brief return the statistics of the latency of all transactions
+    //!
+    //! @return RunningStatistics& latency in microseconds
+    //!
+    RunningStatistics& getLatency(void) {
+        return latency;
+    }
+
+    //!
+    //! @brief return the number of recoveries
+    //!
+    //! @return unsigned long
+    //!
+    unsigned long getRecoveries(void) {
+        return recoveries;
+    }
+
+    //!
+    //! @brief clear all metrics
+    //!
+    void resetStatistics(void) {
+        memset(counts, 0, sizeof(counts));
+
+        devices.clear();
+        latency.reset();
+
+        failures   = 0;
+        recoveries = 0;
+    }
+
+    //!
+    //! @brief print the metrics of the bus and of all addresses
+    //!
+    void printStatistics(void) {
+        PRINT_INFO("I2C bus: Ack: %lu  Nak: %lu  Timeout: %lu  Error: %lu  Recoveries: %lu", counts[Ack],
+                   counts[Nak], counts[Timeout], counts[Error], recoveries);
+        PRINT_INFO("I2C latency: Min: %lu us  Max: %lu  Average: %lu", latency.getMin(), latency.getMax(),
+                   latency.getMean());
+
+        for (Device& device : devices) {
+            PRINT_INFO("I2C device 0x%x: Ack: %u  Nak: %u  Timeout: %u  Error: %u  Max: %u us", device.address,
+                       device.counts[Ack], device.counts[Nak], device.counts[Timeout], device.counts[Error],
+                       device.maxLatency);
+        }
+    }
+
+    //! @}
+
+    //!
+    //! @name interface of TwoWire
+    //! @{
+
+    //! @brief start the bus
+    void begin(void) {
+        bus.begin();
+    }
+
+    //!
+    //! @brief set the bus clock, which is restored after a recovery
+    //!
+    //! @param frequency clock in Hz
+    //!
+    void setClock(uint32_t frequency) {
+        clock = frequency;
+
+        bus.setClock(frequency);
+    }
+
+    //!
+    //! @brief start a write transaction
+    //!
+    //! @param address I2C address
+    //!
+    void beginTransmission(uint8_t address) {
+        target = address;
+
+        bus.beginTransmission(address);
+    }
+
+    //!
+    //! @brief queue a byte for the transaction
+    //!
+    //! @param data the byte
+    //! @return size_t number of queued bytes
+    //!
+    size_t write(uint8_t data) {
+        return bus.write(data);
+    }
+
+    //!
+    //! @brief queue bytes for the transaction
+    //!
+    //! @param data the bytes
+    //! @param quantity number of bytes
+    //! @return size_t number of queued bytes
+    //!
+    size_t write(const uint8_t* data, size_t quantity) {
+        return bus.write(data, quantity);
+    }
+
+    //!
+    //! @brief execute the write transaction
+    //!
+    //! @param sendStop false for a repeated start
+    //! @return uint8_t result of the bus
+    //!
+    uint8_t endTransmission(bool sendStop = true) {
+        unsigned long start = RR_MICROS();
+        uint8_t       error = bus.endTransmission(sendStop);
+
+        switch (error) {
+        case 0:
+            record(Ack, RR_MICROS() - start);
+            break;
+        case 2:
+        case 3:
+            record(Nak, RR_MICROS() - start);
+            break;
+        case 5:
+            record(Timeout, RR_MICROS() - start);
+            break;
+        default:
+            record(Error, RR_MICROS() - start);
+            break;
+        }
+
+        return error;
+    }
+
+    //!
+    //! @brief execute a read transaction
+    //!
+    //! @param address I2C address
+    //! @param quantity number of bytes
+    //! @param sendStop false for a repeated start
+    //! @return uint8_t number of received bytes
+    //!
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true) {
+        unsigned long start = RR_MICROS();
+        uint8_t       received;
+
+        target = address;
+
+        // the explicit types avoid ambiguous overloads of TwoWire
+        if (sendStop)
+            received = bus.requestFrom(address, quantity);
+        else
+            received = bus.requestFrom(address, quantity, (uint8_t)0);
+
+        record(received == quantity ? Ack : Nak, RR_MICROS() - start);
+
+        return received;
+    }
+
+    //!
+    //! @brief return the number of received bytes, which have not been read
+    //!
+    //! @return int
+    //!
+    int available(void) {
+        return bus.available();
+    }
+
+    //!
+    //! @brief return the next received byte
+    //!
+    //! @return int the byte, -1 if none is available
+    //!
+    int read(void) {
+        return bus.read();
+    }
+
+    //! @}
+
+  private:
+    //!
+    //! @brief counters of an address
+    //!
+    struct Device {
+        uint8_t  address;         //!< I2C address
+        uint16_t counts[Results]; //!< transactions per result
+        uint16_t maxLatency;      //!< longest transaction in microseconds
+    };
+
+    //!
+    //! @brief find the entry of an address
+    //!
+    //! @param address I2C address
+    //! @return Device* NULL if the address has no entry
+    //!
+    Device* find(uint8_t address) {
+        for (Device& device : devices) {
+            if (device.address == address)
+                return &device;
+        }
+
+        return NULL;
+    }
+
+    //!
+    //! @brief count a transaction and trigger the recovery
+    //!
+    //! @param result result of the transaction
+    //! @param duration duration in microseconds
+    //!
+    void record(Result_t result, unsigned long duration) {
+        Device* device = find(target);
+
+        counts[result]++;
+        latency.add(duration);
+
+        // plain NAKs are no reason for a new entry, NULL if the table is full
+        if (device == NULL && result != Nak) {
+            Device entry = {target, {0}, 0};
+
+            device = devices.add(entry);
+        }
+
+        if (device != NULL) {
+            if (device->counts[result] < 0xFFFF)
+                device->counts[result]++;
+            if (duration > device->maxLatency)
+                device->maxLatency = duration > 0xFFFF ? 0xFFFF : duration;
+        }
+
+        if (result == Timeout || result == Error) {
+            if (++failures >= threshold && threshold > 0)
+                recover();
+        }
+        else
+            failures = 0;
+    }
+
+    Bus&                          bus;             //!< the monitored bus
+    uint8_t                       sda;             //!< pin of SDA
+    uint8_t                       scl;             //!< pin of SCL
+    uint8_t                       threshold;       //!< failures in a row, which trigger a recovery
+    uint8_t                       failures;        //!< failures in a row
+    uint8_t                       target;          //!< address of the current transaction
+    uint32_t                      clock;           //!< bus clock, 0 = default
+    Recovery_t                    recovery;        //!< recovery function, NULL = recoverI2C()
+    void*                         context;         //!< parameter of recovery
+    unsigned long                 counts[Results]; //!< transactions per result
+    unsigned long                 recoveries;      //!< number of recoveries
+    RunningStatistics             latency;         //!< latency of all transactions
+    StaticVector<Device, Devices> devices;         //!< counters per address
+};
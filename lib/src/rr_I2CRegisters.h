@@ -0,0 +1,415 @@
+//!
+//! @file rr_I2CRegisters.h
+//! @author M. Nickels
+//! @brief register access to I2C devices with bursts and queued transactions
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// own includes
+#include "rr_Clock.h"
+
+//!
+//! @brief bytes per transaction of the bus
+//! @details The buffer of TwoWire has 32 bytes on AVR. Longer bursts are split into several transactions, the
+//!          register address is incremented accordingly.
+//!
+#ifndef I2C_BUFFER_LENGTH
+    #define I2C_BUFFER_LENGTH 32
+#endif
+
+//!
+//! @brief read consecutive registers of a device
+//! @details The register address is written followed by a repeated start and the read. The device must increment
+//!          the register address after every byte.
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @param bus the bus
+//! @param address I2C address
+//! @param reg first register
+//! @param data receives the content of the registers
+//! @param length number of registers
+//! @return true if successful
+//!
+template <class Bus>
+bool readI2CRegisters(Bus& bus, uint8_t address, uint8_t reg, uint8_t* data, uint8_t length) {
+    while (length > 0) {
+        uint8_t chunk = length > I2C_BUFFER_LENGTH ? I2C_BUFFER_LENGTH : length;
+
+        bus.beginTransmission(address);
+        bus.write(reg);
+
+        if (bus.endTransmission(false) != 0 || bus.requestFrom(address, chunk) != chunk)
+            return false;
+
+        for (uint8_t index = 0; index < chunk; index++)
+            *data++ = bus.read();
+
+        reg += chunk;
+        length -= chunk;
+    }
+
+    return true;
+}
+
+//!
+//! @brief write consecutive registers of a device
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @param bus the bus
+//! @param address I2C address
+//! @param reg first register
+//! @param data new content of the registers
+//! @param length number of registers
+//! @return true if successful
+//!
+template <class Bus>
+bool writeI2CRegisters(Bus& bus, uint8_t address, uint8_t reg, const uint8_t* data, uint8_t length) {
+    do {
+        // one byte of the buffer is used by the register address
+        uint8_t chunk = length > I2C_BUFFER_LENGTH - 1 ? I2C_BUFFER_LENGTH - 1 : length;
+
+        bus.beginTransmission(address);
+        bus.write(reg);
+        bus.write(data, chunk);
+
+        if (bus.endTransmission() != 0)
+            return false;
+
+        data += chunk;
+        reg += chunk;
+        length -= chunk;
+    } while (length > 0);
+
+    return true;
+}
+
+//!
+//! @brief read a single register
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @param bus the bus
+//! @param address I2C address
+//! @param reg register
+//! @param value receives the content of the register
+//! @return true if successful
+//!
+template <class Bus> bool readI2CRegister(Bus& bus, uint8_t address, uint8_t reg, uint8_t& value) {
+    return readI2CRegisters(bus, address, reg, &value, 1);
+}
+
+//!
+//! @brief write a single register
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @param bus the bus
+//! @param address I2C address
+//! @param reg register
+//! @param value new content of the register
+//! @return true if successful
+//!
+template <class Bus> bool writeI2CRegister(Bus& bus, uint8_t address, uint8_t reg, uint8_t value) {
+    return writeI2CRegisters(bus, address, reg, &value, 1);
+}
+
+//!
+//! @brief register access to a device
+//!
+//!          @code
+//!          I2CDevice imu(0x68);
+//!          uint8_t   raw[14];
+//!
+//!          imu.writeRegister(0x6B, 0x00);
+//!          imu.readRegisters(0x3B, raw, sizeof(raw));
+//!          @endcode
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//!
+template <class Bus> class I2CBusDevice {
+
+  public:
+    //!
+    //! @brief Construct a new I2CBusDevice object on Wire
+    //!
+    //! @param newAddress I2C address
+    //!
+    I2CBusDevice(uint8_t newAddress) : bus(Wire) {
+        address = newAddress;
+    }
+
+    //!
+    //! @brief Construct a new I2CBusDevice object
+    //!
+    //! @param newBus the bus
+    //! @param newAddress I2C address
+    //!
+    I2CBusDevice(Bus& newBus, uint8_t newAddress) : bus(newBus) {
+        address = newAddress;
+    }
+
+    //!
+    //! @brief return the address of the device
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getAddress(void) {
+        return address;
+    }
+
+    //!
+    //! @brief read consecutive registers in one burst
+    //!
+    //! @param reg first register
+    //! @param data receives the content of the registers
+    //! @param length number of registers
+    //! @return true if successful
+    //!
+    bool readRegisters(uint8_t reg, uint8_t* data, uint8_t length) {
+        return readI2CRegisters(bus, address, reg, data, length);
+    }
+
+    //!
+    //! @brief write consecutive registers in one burst
+    //!
+    //! @param reg first register
+    //! @param data new content of the registers
+    //! @param length number of registers
+    //! @return true if successful
+    //!
+    bool writeRegisters(uint8_t reg, const uint8_t* data, uint8_t length) {
+        return writeI2CRegisters(bus, address, reg, data, length);
+    }
+
+    //!
+    //! @brief read a single register
+    //!
+    //! @param reg register
+    //! @param value receives the content of the register
+    //! @return true if successful
+    //!
+    bool readRegister(uint8_t reg, uint8_t& value) {
+        return readI2CRegisters(bus, address, reg, &value, 1);
+    }
+
+    //!
+    //! @brief write a single register
+    //!
+    //! @param reg register
+    //! @param value new content of the register
+    //! @return true if successful
+    //!
+    bool writeRegister(uint8_t reg, uint8_t value) {
+        return writeI2CRegisters(bus, address, reg, &value, 1);
+    }
+
+  private:
+    Bus&    bus;     //!< the bus
+    uint8_t address; //!< I2C address
+};
+
+//! @brief register access to a device on Wire
+typedef I2CBusDevice<TwoWire> I2CDevice;
+
+//!
+//! @brief a burst transaction for I2CBusQueue
+//! @details The buffer is owned by the caller and must stay valid until the transaction has completed.
+//!
+struct I2CTransaction {
+    //!
+    //! @brief state of the transaction
+    //!
+    typedef enum {
+        Idle,    //!< not queued
+        Pending, //!< queued
+        Done,    //!< completed successfully
+        Failed   //!< completed with an error
+    } Status_t;
+
+    uint8_t           address; //!< I2C address
+    uint8_t           reg;     //!< first register
+    uint8_t*          data;    //!< buffer of the registers
+    uint8_t           length;  //!< number of registers
+    bool              write;   //!< true = write, false = read
+    volatile Status_t status;  //!< state of the transaction
+};
+
+//!
+//! @brief queue of transactions, which are executed back to back
+//! @details run() executes all queued transactions at once, step() executes them in a periodic loop within a time
+//!          budget. The Arduino cores offer no asynchronous I2C transfer, therefore the non-blocking mode is
+//!          cooperative: a transaction is completed when its status changes or when the callback is called.
+//!
+//!          @code
+//!          I2CBusQueue<TwoWire, 4> queue;
+//!          I2CTransaction          accel = {0x68, 0x3B, raw, 14, false, I2CTransaction::Idle};
+//!
+//!          queue.add(accel);
+//!
+//!          void loop() {
+//!              queue.step(500);
+//!              if (accel.status == I2CTransaction::Done) ...
+//!              intervall.wait();
+//!          }
+//!          @endcode
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @tparam Size maximum number of queued transactions
+//!
+template <class Bus, uint8_t Size> class I2CBusQueue {
+
+  public:
+    //!
+    //! @brief called after a transaction has completed
+    //!
+    //! @param transaction the transaction
+    //! @param context context given to setCallback()
+    //!
+    typedef void (*Callback_t)(I2CTransaction& transaction, void* context);
+
+    //!
+    //! @brief Construct a new I2CBusQueue object
+    //!
+    //! @param newBus the bus
+    //!
+    I2CBusQueue(Bus& newBus = Wire) : bus(newBus) {
+        head     = 0;
+        count    = 0;
+        maxTime  = 0;
+        callback = NULL;
+        context  = NULL;
+    }
+
+    //!
+    //! @brief set the function, which is called after every transaction
+    //!
+    //! @param newCallback the function, NULL = none
+    //! @param newContext parameter of the function
+    //!
+    void setCallback(Callback_t newCallback, void* newContext = NULL) {
+        callback = newCallback;
+        context  = newContext;
+    }
+
+    //!
+    //! @brief queue a transaction
+    //!
+    //! @param transaction the transaction, the status is set to Pending
+    //! @return true if queued, false if the queue is full
+    //!
+    bool add(I2CTransaction& transaction) {
+        if (count >= Size)
+            return false;
+
+        transaction.status             = I2CTransaction::Pending;
+        queue[(head + count++) % Size] = &transaction;
+
+        return true;
+    }
+
+    //!
+    //! @brief execute all queued transactions
+    //!
+    //! @return uint8_t number of failed transactions
+    //!
+    uint8_t run(void) {
+        uint8_t failed = 0;
+
+        while (count > 0) {
+            if (!execute())
+                failed++;
+        }
+
+        return failed;
+    }
+
+    //!
+    //! @brief execute the next transactions within a time budget
+    //! @details At least one transaction is executed per call. A further transaction is only executed if the
+    //!          longest transaction so far still fits into the budget.
+    //!
+    //! @param maxMicros time budget in microseconds, 0 = no limit
+    //! @return true if the queue is empty
+    //!
+    bool step(unsigned long maxMicros = 0) {
+        unsigned long start = RR_MICROS();
+
+        for (uint8_t executed = 0; count > 0; executed++) {
+            unsigned long before = RR_MICROS();
+
+            // does another transaction fit into the budget?
+            if (executed > 0 && maxMicros > 0 && before - start + maxTime > maxMicros)
+                break;
+
+            execute();
+
+            if (RR_MICROS() - before > maxTime)
+                maxTime = RR_MICROS() - before;
+        }
+
+        return count == 0;
+    }
+
+    //!
+    //! @brief return the number of queued transactions
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getCount(void) {
+        return count;
+    }
+
+    //!
+    //! @brief return the longest duration of a transaction
+    //!
+    //! @return unsigned long microseconds
+    //!
+    unsigned long getMaxTime(void) {
+        return maxTime;
+    }
+
+  private:
+    //!
+    //! @brief execute the first queued transaction
+    //!
+    //! @return true if successful
+    //!
+    bool execute(void) {
+        I2CTransaction& transaction = *queue[head];
+        bool            success;
+
+        head = (head + 1) % Size;
+        count--;
+
+        if (transaction.write)
+            success = writeI2CRegisters(bus, transaction.address, transaction.reg, transaction.data,
+                                        transaction.length);
+        else
+            success = readI2CRegisters(bus, transaction.address, transaction.reg, transaction.data,
+                                       transaction.length);
+
+        transaction.status = success ? I2CTransaction::Done : I2CTransaction::Failed;
+
+        if (callback)
+            callback(transaction, context);
+
+        return success;
+    }
+
+    Bus&            bus;         //!< the bus
+    I2CTransaction* queue[Size]; //!< queued transactions
+    uint8_t         head;        //!< index of the first transaction
+    uint8_t         count;       //!< number of queued transactions
+    unsigned long   maxTime;     //!< longest transaction in microseconds
+    Callback_t      callback;    //!< called after every transaction
+    void*           context;     //!< parameter of callback
+};
@@ -13,130 +13,531 @@
 
 #include <Arduino.h>
 
-#include <limits.h>
-#ifndef ARDUINO_ARCH_AVR
-    #include <algorithm>
-
-//!
-//! @name Functions not include in AVR environment
-//!
-//! @{
+// own includes
+#include "rr_Clock.h"
+#include "rr_DebugUtils.h"
+#include "rr_Intervall.h"
 
-    //! @brief calculate minimum
-    #define min(a, b) std::min((a), (b))
+#ifdef WITH_INTERVALL_ADAPTIVE
+static_assert(4L * INTERVALL_ADAPT_HOLD <= INT16_MAX, "INTERVALL_ADAPT_HOLD exceeds the adaption counter");
+#endif
 
-    //! @brief calculate maximum
-    #define max(a, b) std::max((a), (b))
-//! @}
+#ifdef WITH_INTERVALL_TRACE
+uint8_t                                                   Intervall::nextId = 1;
+RingBuffer<Intervall::TraceEvent_t, INTERVALL_TRACE_SIZE> Intervall::trace;
 #endif
 
-// own includes
-#include "rr_DebugUtils.h"
-#include "rr_Intervall.h"
+#ifdef WITH_INTERVALL_REGISTRY
+Intervall* Intervall::first = NULL;
+#endif
 
 Intervall::Intervall() {
     timeStamp = 0;
+    phase     = 0;
+    skew      = 0;
+
+#ifdef WITH_INTERVALL_TRACE
+    id = nextId++;
+#endif
+
+#ifdef WITH_INTERVALL_REGISTRY
+    name = NULL;
+    next = NULL;
+#endif
 
     // assume a default of 100ms
     setPeriod(100);
 
 #ifndef WITHOUT_INTERVALL_STATS
+    loadWindow = 100;
+
     resetStatistics();
 #endif
+
+#ifdef WITH_INTERVALL_ADAPTIVE
+    adaptMin       = 0;
+    adaptMax       = 0;
+    adaptCount     = 0;
+    periodChanges  = 0;
+    onPeriodChange = NULL;
+#endif
 }
 
 Intervall::Intervall(Period_t newPeriod) : Intervall() {
     setPeriod(newPeriod);
 }
 
+#ifdef WITH_INTERVALL_REGISTRY
+Intervall::~Intervall() {
+    unregister();
+}
+#endif
+
 void Intervall::setPeriod(Period_t newPeriod) {
     period = newPeriod;
 }
 
+Intervall::Period_t Intervall::getPeriod(void) {
+    return period;
+}
+
+void Intervall::setPhase(Period_t offset) {
+    phase = offset;
+}
+
+Intervall::Period_t Intervall::getPhase(void) {
+    return phase;
+}
+
+void Intervall::stagger(Intervall* group[], uint8_t count) {
+    unsigned long now    = RR_MILLIS();
+    Period_t      common = 0;
+
+    // greatest common divisor of all periods
+    for (uint8_t index = 0; index < count; index++) {
+        Period_t a = group[index]->period;
+        Period_t b = common;
+
+        while (b != 0) {
+            Period_t rest = a % b;
+
+            a = b;
+            b = rest;
+        }
+
+        common = a;
+    }
+
+    for (uint8_t index = 0; index < count; index++) {
+        group[index]->phase = (unsigned long)common * index / count;
+        group[index]->start(now);
+    }
+}
+
 void Intervall::begin(void) {
-    timeStamp = millis();
+    start(RR_MILLIS());
+}
+
+void Intervall::start(unsigned long now) {
+    Period_t offset = period > 0 ? phase % period : 0;
+
+    // move the start into the past, so the first period ends after offset
+    skew      = offset > 0 ? period - offset : 0;
+    timeStamp = now - skew;
+
+    // 0 marks an intervall, which has not begun, a later time stamp would lie in the future
+    if (timeStamp == 0)
+        timeStamp--;
 }
 
 bool Intervall::isPeriodOver(void) {
     if (timeStamp == 0)
         return true;
     else
-        return millis() - timeStamp >= period;
+        return RR_MILLIS() - timeStamp >= period;
+}
+
+unsigned long Intervall::getDeadline(void) {
+    return timeStamp + period;
 }
 
+//! @brief adapter for a callback without parameters
+struct PlainCallback {
+    bool (*userFunc)(void); //!< the callback
+
+    //! @brief call the callback
+    bool operator()(void) {
+        return userFunc != NULL && userFunc();
+    }
+};
+
+//! @brief adapter for a callback with a context
+struct ContextCallback {
+    bool (*userFunc)(void*); //!< the callback
+    void* context;           //!< parameter of the callback
+
+    //! @brief call the callback
+    bool operator()(void) {
+        return userFunc != NULL && userFunc(context);
+    }
+};
+
 Intervall::Result_t Intervall::wait(bool (*userFunc)(void)) {
-    Intervall::Period_t delta  = millis() - timeStamp;
-    Result_t            result = Success;
+    PlainCallback callback = {userFunc};
+
+    return waitFor(callback);
+}
+
+Intervall::Result_t Intervall::wait(bool (*userFunc)(void*), void* context) {
+    ContextCallback callback = {userFunc, context};
+
+    return waitFor(callback);
+}
+
+Intervall::Result_t Intervall::startWait(void) {
+    Intervall::Period_t elapsed = RR_MILLIS() - timeStamp;
+    Intervall::Period_t delta   = elapsed - skew;
 
     if (timeStamp == 0) {
         PRINT_ERROR("Intervall not initialized. Call begin() before wait()", NULL);
         return Intervall::Failure;
     }
 
+    skew = 0;
+
 #ifndef WITHOUT_INTERVALL_STATS
     // collect statistics
-    minPeriod = min(minPeriod, delta);
-    maxPeriod = max(maxPeriod, delta);
+    statistics.add(delta);
+
+    // collect load
+    lastBusy = delta;
 
-    // check for overflow
-    if (sumPeriods > ULONG_MAX - delta) {
-        PRINT_WARNING("Average overflow, resetting average", NULL);
+    if (delta > windowPeak)
+        windowPeak = delta;
 
-        sumPeriods = getAvgPeriod() + delta;
-        numPeriods = 2;
+    if (++windowCount >= loadWindow) {
+        lastWindowPeak = windowPeak;
+        windowPeak     = 0;
+        windowCount    = 0;
     }
-    else {
-        sumPeriods += delta;
-        numPeriods++;
+#endif
+
+    if (elapsed < period) {
+#ifdef WITH_INTERVALL_ADAPTIVE
+        adaptPeriod();
+#endif
+        return Success;
     }
+    else {
+        reportOverrun(delta);
+
+#ifdef WITH_INTERVALL_ADAPTIVE
+        adaptPeriod();
 #endif
+        return Overflow;
+    }
+}
 
-    if (delta < period) {
-        while (!isPeriodOver()) {
-            if (userFunc != NULL && userFunc()) {
-                result = Abort;
-                break;
-            }
+Intervall::Status_t Intervall::poll(void) {
+    unsigned long now = RR_MILLIS();
+    Period_t      elapsed;
 
-            yield();
-        }
+    if (timeStamp == 0) {
+        start(now);
+        return Due;
     }
-    else {
-        PRINT_WARNING("Intervall overflow. Intervall: %u  current: %u", period, delta);
 
-        result = Overflow;
+    elapsed = now - timeStamp;
+
+    if (elapsed < period)
+        return NotDue;
+
+    skew = 0;
+
+    if (elapsed - period >= period) {
+        reportOverrun(elapsed);
+
+        timeStamp = now;
+        return Overrun;
+    }
+    else {
+        timeStamp += period;
+        return Due;
     }
+}
+
+void Intervall::reportOverrun(Period_t duration) {
+#ifndef WITHOUT_INTERVALL_STATS
+    overruns++;
+#endif
+
+#ifdef WITH_INTERVALL_TRACE
+    TraceEvent_t event;
+
+    event.timeStamp = RR_MILLIS();
+    event.period    = period;
+    event.duration  = duration;
+    event.id        = id;
+
+    // the oldest event is dropped
+    trace.pushOverwrite(event);
+#else
+    PRINT_WARNING("Intervall overflow. Intervall: %u  current: %u", period, duration);
+#endif
+}
+
+#ifdef WITH_INTERVALL_TRACE
+
+void Intervall::setId(uint8_t newId) {
+    id = newId;
+}
+
+uint8_t Intervall::getId(void) {
+    return id;
+}
+
+uint8_t Intervall::getTraceCount(void) {
+    return trace.getCount();
+}
 
-    timeStamp = millis();
+bool Intervall::getTraceEvent(uint8_t index, TraceEvent_t& event) {
+    if (index >= trace.getCount())
+        return false;
+
+    // newest first
+    event = trace[trace.getCount() - 1 - index];
+
+    return true;
+}
 
-    return result;
+void Intervall::clearTrace(void) {
+    trace.clear();
+}
+
+void Intervall::printTrace(void) {
+    TraceEvent_t event;
+
+    PRINT_INFO("Intervall overruns: %u", trace.getCount());
+
+    for (uint8_t index = 0; getTraceEvent(index, event); index++) {
+        PRINT_INFO("Time: %lu  Id: %u  Intervall: %u  current: %u", event.timeStamp, event.id, event.period,
+                   event.duration);
+    }
 }
 
+#endif // WITH_INTERVALL_TRACE
+
 #ifndef WITHOUT_INTERVALL_STATS
 
 Intervall::Period_t Intervall::getMinPeriod() {
-    return minPeriod;
+    return statistics.getMin();
 }
 
 Intervall::Period_t Intervall::getMaxPeriod() {
-    return maxPeriod;
+    return statistics.getMax();
 }
 
 Intervall::Period_t Intervall::getAvgPeriod() {
-    return sumPeriods / numPeriods;
+    return statistics.getMean();
+}
+
+Intervall::Period_t Intervall::getStdDevPeriod() {
+    return statistics.getStdDev();
+}
+
+Intervall::Period_t Intervall::getEwmaPeriod() {
+    return statistics.getEwma();
+}
+
+void Intervall::setEwmaShift(uint8_t shift) {
+    statistics.setEwmaShift(shift);
+}
+
+unsigned Intervall::getLoad(void) {
+    if (period == 0)
+        return 0;
+
+    return (unsigned long)lastBusy * 1000 / period;
+}
+
+unsigned Intervall::getAvgLoad(void) {
+    if (period == 0)
+        return 0;
+
+    // ewma is Q23.8: ewma * 1000 / (period * 256)
+    return (unsigned long)statistics.getEwmaFixed() * 125 / period / 32;
+}
+
+unsigned Intervall::getPeakLoad(void) {
+    Period_t peak = windowPeak > lastWindowPeak ? windowPeak : lastWindowPeak;
+
+    if (period == 0)
+        return 0;
+
+    return (unsigned long)peak * 1000 / period;
+}
+
+Intervall::Period_t Intervall::getHeadroom(void) {
+    Period_t peak = windowPeak > lastWindowPeak ? windowPeak : lastWindowPeak;
+
+    return peak < period ? period - peak : 0;
+}
+
+void Intervall::setLoadWindow(unsigned periods) {
+    loadWindow = periods > 0 ? periods : 1;
+}
+
+#ifdef WITH_INTERVALL_ADAPTIVE
+
+void Intervall::setAdaptive(Period_t minPeriod, Period_t maxPeriod, PeriodCallback_t onChange) {
+    adaptMin       = minPeriod > 0 ? minPeriod : 1;
+    adaptMax       = maxPeriod > adaptMin ? maxPeriod : adaptMin;
+    adaptCount     = 0;
+    onPeriodChange = onChange;
+
+    // a period outside of the range would be shrunk by a stretch or stretched by a shrink
+    if (period < adaptMin)
+        period = adaptMin;
+    else if (period > adaptMax)
+        period = adaptMax;
+}
+
+void Intervall::disableAdaptive(void) {
+    adaptMin = 0;
+}
+
+unsigned Intervall::getPeriodChanges(void) {
+    return periodChanges;
+}
+
+void Intervall::adaptPeriod(void) {
+    unsigned long load;
+    unsigned long target;
+    Period_t      newPeriod = period;
+
+    if (adaptMin == 0)
+        return;
+
+    load = getAvgLoad();
+
+    // count consecutive over/underloaded periods, a period in between resets the count
+    if (load > INTERVALL_ADAPT_HIGH) {
+        if (adaptCount < 0)
+            adaptCount = 0;
+        if (adaptCount < INTERVALL_ADAPT_HOLD)
+            adaptCount++;
+    }
+    else if (load < INTERVALL_ADAPT_LOW) {
+        if (adaptCount > 0)
+            adaptCount = 0;
+        if (adaptCount > -4 * INTERVALL_ADAPT_HOLD)
+            adaptCount--;
+    }
+    else
+        adaptCount = 0;
+
+    // period for the target load, ewma is Q23.8
+    target = ((unsigned long)statistics.getEwmaFixed() * (1000 / 8) / INTERVALL_ADAPT_TARGET) >> 5;
+
+    if (adaptCount >= INTERVALL_ADAPT_HOLD) {
+        newPeriod = target > adaptMax ? adaptMax : target;
+        if (newPeriod <= period)
+            newPeriod = period < adaptMax ? period + 1 : adaptMax;
+    }
+    else if (adaptCount <= -4 * INTERVALL_ADAPT_HOLD) {
+        // shrink slowly to avoid oscillation
+        Period_t lowest = period - period / 8;
+
+        newPeriod = target > lowest ? target : lowest;
+        if (newPeriod < adaptMin)
+            newPeriod = adaptMin;
+    }
+
+    if (newPeriod != period) {
+        period     = newPeriod;
+        adaptCount = 0;
+        periodChanges++;
+
+        if (onPeriodChange)
+            onPeriodChange(period);
+    }
 }
 
+#endif // WITH_INTERVALL_ADAPTIVE
+
 void Intervall::resetStatistics(void) {
-    maxPeriod  = 0;
-    minPeriod  = UINT_MAX;
+    statistics.reset();
 
-    numPeriods = 0;
-    sumPeriods = 0;
+    lastBusy       = 0;
+    windowPeak     = 0;
+    lastWindowPeak = 0;
+    windowCount    = 0;
+    overruns       = 0;
 }
 
 void Intervall::printStatistics(void) {
-    PRINT_INFO("Intervall statistics: Period: %u  Min: %u  Max: %u  Average: %u", period, getMinPeriod(),
-               getMaxPeriod(), getAvgPeriod());
+    PRINT_INFO("Intervall statistics: Period: %u  Min: %u  Max: %u  Average: %u  StdDev: %u  EWMA: %u", period,
+               getMinPeriod(), getMaxPeriod(), getAvgPeriod(), getStdDevPeriod(), getEwmaPeriod());
+    PRINT_INFO("Intervall load: Last: %u.%u%%  Average: %u.%u%%  Peak: %u.%u%%  Headroom: %u ms", getLoad() / 10,
+               getLoad() % 10, getAvgLoad() / 10, getAvgLoad() % 10, getPeakLoad() / 10, getPeakLoad() % 10,
+               getHeadroom());
+}
+
+unsigned Intervall::getOverruns(void) {
+    return overruns;
 }
 
 #endif // WITHOUT_INTERVALL_STATS
+
+#ifdef WITH_INTERVALL_REGISTRY
+
+void Intervall::registerAs(const __FlashStringHelper* newName) {
+    name = newName;
+
+    for (Intervall* intervall = first; intervall != NULL; intervall = intervall->next) {
+        if (intervall == this)
+            return;
+    }
+
+    next  = first;
+    first = this;
+}
+
+void Intervall::unregister(void) {
+    for (Intervall** link = &first; *link != NULL; link = &(*link)->next) {
+        if (*link == this) {
+            *link = next;
+            next  = NULL;
+            return;
+        }
+    }
+}
+
+const __FlashStringHelper* Intervall::getName(void) {
+    return name;
+}
+
+Intervall* Intervall::getFirst(void) {
+    return first;
+}
+
+Intervall* Intervall::getNext(void) {
+    return next;
+}
+
+void Intervall::printReport(void) {
+    #ifdef __PLATFORMIO_BUILD_DEBUG__
+    unsigned tabs[] = {40, 56, 64, 72, 80, 88, 98, 106};
+
+    Debug.setTabs(tabs, sizeof(tabs) / sizeof(tabs[0]));
+    #endif
+
+    PRINT_INFO("Name\tPeriod\tMin\tMax\tAvg\tOverruns\tLoad\tPeak", NULL);
+
+    for (Intervall* intervall = first; intervall != NULL; intervall = intervall->next) {
+        PRINT_INFO(RR_FLASH_FMT "\t%u\t%u\t%u\t%u\t%u\t%u.%u%%\t%u.%u%%",
+                   reinterpret_cast<const char*>(intervall->name != NULL ? intervall->name : F("-")), intervall->period,
+                   intervall->getMinPeriod(), intervall->getMaxPeriod(), intervall->getAvgPeriod(),
+                   intervall->overruns, intervall->getAvgLoad() / 10, intervall->getAvgLoad() % 10,
+                   intervall->getPeakLoad() / 10, intervall->getPeakLoad() % 10);
+    }
+
+    #ifdef __PLATFORMIO_BUILD_DEBUG__
+    Debug.clearTabs();
+    #endif
+}
+
+void Intervall::resetAllStatistics(void) {
+    #ifdef ARDUINO
+    noInterrupts();
+    #endif
+
+    for (Intervall* intervall = first; intervall != NULL; intervall = intervall->next)
+        intervall->resetStatistics();
+
+    #ifdef ARDUINO
+    interrupts();
+    #endif
+}
+
+#endif // WITH_INTERVALL_REGISTRY
@@ -14,8 +14,58 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 // own includes
+#include "rr_Clock.h"
+#include "rr_Containers.h"
+#include "rr_Statistics.h"
+
+//!
+//! @brief number of overrun events kept in the trace
+//! @note add -DWITH_INTERVALL_TRACE to your compiler flags to include the trace
+//!
+#ifndef INTERVALL_TRACE_SIZE
+    #define INTERVALL_TRACE_SIZE 8
+#endif
+
+//!
+//! @name Parameters of the adaptive period
+//! @note add -DWITH_INTERVALL_ADAPTIVE to your compiler flags to include the adaptive period
+//! @{
+
+#ifndef INTERVALL_ADAPT_HIGH
+    #define INTERVALL_ADAPT_HIGH 900 //!< stretch the period above this load (permille)
+#endif
+
+#ifndef INTERVALL_ADAPT_LOW
+    #define INTERVALL_ADAPT_LOW 500 //!< shrink the period below this load (permille)
+#endif
+
+#ifndef INTERVALL_ADAPT_TARGET
+    #define INTERVALL_ADAPT_TARGET 750 //!< load after an adaption (permille)
+#endif
+
+#ifndef INTERVALL_ADAPT_HOLD
+    #define INTERVALL_ADAPT_HOLD 4 //!< number of overloaded periods before the period is stretched
+#endif
+
+//! @}
+
+//!
+//! @brief the registry needs the statistics
+//! @note add -DWITH_INTERVALL_REGISTRY to your compiler flags to include the registry
+//!
+#if defined(WITHOUT_INTERVALL_STATS) && defined(WITH_INTERVALL_REGISTRY)
+    #undef WITH_INTERVALL_REGISTRY
+#endif
+
+//!
+//! @brief the adaptive period needs the statistics
+//!
+#if defined(WITHOUT_INTERVALL_STATS) && defined(WITH_INTERVALL_ADAPTIVE)
+    #undef WITH_INTERVALL_ADAPTIVE
+#endif
 
 //!
 //! @brief this class implements the intervall functions
@@ -28,6 +78,8 @@ class Intervall {
   public:
     typedef unsigned int Period_t; //!< current period in milliseconds
 
+    typedef void (*PeriodCallback_t)(Period_t newPeriod); //!< called if the adaptive period changes
+
     //! wait results
     typedef enum {
         Success,  //!< wait terminated within period
@@ -36,6 +88,13 @@ class Intervall {
         Failure   //!< an error occured
     } Result_t;
 
+    //! poll results
+    typedef enum {
+        NotDue, //!< period is not over yet
+        Due,    //!< period is over, the next period has been started
+        Overrun //!< period is over and at least one further period has been missed
+    } Status_t;
+
     //!
     //! @brief Construct a new Intervall:: Intervall object default intervall length
     //!
@@ -48,6 +107,13 @@ class Intervall {
     //!
     Intervall(Period_t newPeriod);
 
+#ifdef WITH_INTERVALL_REGISTRY
+    //!
+    //! @brief Destroy the Intervall object, a registered intervall is removed from the registry
+    //!
+    ~Intervall();
+#endif
+
     //!
     //! @brief set the period length
     //!
@@ -55,6 +121,44 @@ class Intervall {
     //!
     void setPeriod(Period_t newPeriod);
 
+    //!
+    //! @brief return the period length
+    //!
+    //! @return Intervall::Period_t period length in milliseconds
+    //!
+    Period_t getPeriod(void);
+
+    //!
+    //! @brief set the phase offset
+    //! @details The first period after begin() ends after offset milliseconds instead of a full period, so
+    //!          all following periods are shifted by offset. Intervalls with harmonic periods and different
+    //!          offsets do not end in the same millisecond, which spreads their load. The offset takes
+    //!          effect with the next begin().
+    //!
+    //! @param offset phase offset in milliseconds, 0 (default) or a multiple of the period means no offset
+    //!
+    void setPhase(Period_t offset);
+
+    //!
+    //! @brief return the phase offset
+    //!
+    //! @return Intervall::Period_t phase offset in milliseconds
+    //!
+    Period_t getPhase(void);
+
+    //!
+    //! @brief begin a group of intervalls with staggered phases
+    //! @details The phase offsets are spread evenly across the greatest common divisor of all periods
+    //!          (e.g. 0, 2, 5 and 7 ms for four intervalls of 10, 20, 50 and 100 ms). As long as the group has
+    //!          no more members than this divisor, no two intervalls end in the same millisecond.
+    //!          All intervalls are started at the same time, begin() must not be called afterwards.
+    //!          Compare getPeakLoad() and getAvgLoad() of the fastest intervall to check the effect.
+    //!
+    //! @param group array of intervalls
+    //! @param count number of intervalls
+    //!
+    static void stagger(Intervall* group[], uint8_t count);
+
     //!
     //! @brief initialize an intervall.
     //!
@@ -72,6 +176,57 @@ class Intervall {
     //!
     Result_t wait(bool (*userFunc)(void) = NULL);
 
+    //!
+    //! @brief wait until the next intervall shall be started
+    //! @details same as wait(), but the callback receives a context pointer
+    //! @pre Ensure that begin() has been called before.
+    //! @param userFunc if not null and this functions returns true, the intervall is aborted
+    //! @param context passed to userFunc
+    //! @return result of the intervall
+    //!
+    Result_t wait(bool (*userFunc)(void* context), void* context);
+
+    //!
+    //! @brief wait until the next intervall shall be started
+    //! @details same as wait(), but calls a functor (object with `bool operator()()` or a lambda).
+    //!          The functor is passed by reference, so a temporary lambda can be passed as well. Nothing is
+    //!          copied or allocated.
+    //! @pre Ensure that begin() has been called before.
+    //! @param functor if this functor returns true, the intervall is aborted
+    //! @return result of the intervall
+    //!
+    template <typename Functor> Result_t waitFor(Functor&& functor) {
+        Result_t result = startWait();
+
+        if (result == Success) {
+            while (!isPeriodOver()) {
+                if (functor()) {
+                    result = Abort;
+                    break;
+                }
+
+                RR_YIELD();
+            }
+        }
+
+        if (result != Failure)
+            timeStamp = RR_MILLIS();
+
+        return result;
+    }
+
+    //!
+    //! @brief non blocking check for the end of the period
+    //! @details If the period is over the next period is started immediately. The next period starts at the end
+    //!          of the previous one, so there is no drift. poll() knows no busy time, the statistics and the load
+    //!          are only recorded by wait(), overruns are counted by both. After an overrun the intervall is
+    //!          synchronized to the current time.
+    //!          If begin() has not been called, the first call starts the intervall and returns Due.
+    //!
+    //! @return Intervall::Status_t
+    //!
+    Status_t poll(void);
+
     //!
     //! @brief check if ccurent period is over
     //! @startuml
@@ -83,6 +238,76 @@ class Intervall {
     //!
     bool isPeriodOver(void);
 
+    //!
+    //! @brief return the end of the current period
+    //!
+    //! @return unsigned long time in milliseconds, when isPeriodOver() becomes true
+    //!
+    unsigned long getDeadline(void);
+
+#ifdef WITH_INTERVALL_TRACE
+
+    //! @name Overrun trace
+    //! @details The last #INTERVALL_TRACE_SIZE overflows of wait() and overruns of poll() of all intervalls are
+    //!          recorded in a ring buffer in RAM. Recording replaces the warning output, because printing
+    //!          would delay the next period as well. HardwareIntervall records its overflows here too.
+    //! @note add -DWITH_INTERVALL_TRACE to your compiler flags to include the trace
+    //! @{
+
+    //! an overrun event
+    typedef struct {
+        unsigned long timeStamp; //!< time of the overrun in milliseconds
+        Period_t      period;    //!< configured period, microseconds for a HardwareIntervall (saturated)
+        Period_t      duration;  //!< actual duration, microseconds for a HardwareIntervall (saturated)
+        uint8_t       id;        //!< id of the intervall
+    } TraceEvent_t;
+
+    //!
+    //! @brief set the id of the intervall
+    //! @details The constructor assigns ascending ids starting at 1
+    //!
+    //! @param newId id recorded in the trace
+    //!
+    void setId(uint8_t newId);
+
+    //!
+    //! @brief return the id of the intervall
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getId(void);
+
+    //!
+    //! @brief return the number of recorded events
+    //!
+    //! @return uint8_t at most #INTERVALL_TRACE_SIZE
+    //!
+    static uint8_t getTraceCount(void);
+
+    //!
+    //! @brief read a recorded event
+    //!
+    //! @param index 0 is the latest event
+    //! @param event receives the event
+    //! @return true if the event exists
+    //! @return false otherwise
+    //!
+    static bool getTraceEvent(uint8_t index, TraceEvent_t& event);
+
+    //!
+    //! @brief forget all recorded events
+    //!
+    static void clearTrace(void);
+
+    //!
+    //! @brief show all recorded events, latest first
+    //!
+    static void printTrace(void);
+
+    //! @}
+
+#endif
+
 #ifndef WITHOUT_INTERVALL_STATS
 
     //! @name Statistics functions
@@ -111,6 +336,110 @@ class Intervall {
     //!
     Period_t getAvgPeriod();
 
+    //!
+    //! @brief return the standard deviation of the wait period
+    //!
+    //! @return Intervall::Period_t
+    //!
+    Period_t getStdDevPeriod();
+
+    //!
+    //! @brief return the exponentially weighted moving average of the wait period
+    //!
+    //! @return Intervall::Period_t
+    //!
+    Period_t getEwmaPeriod();
+
+    //!
+    //! @brief set the time constant of the moving average
+    //!
+    //! @param shift the time constant is 2^shift periods
+    //!
+    void setEwmaShift(uint8_t shift);
+
+    //! @}
+
+    //! @name Load functions
+    //! @details The load is the busy part of a period, i.e. the time from begin() (or the end of the
+    //!          previous wait()) until wait() is called. It is only recorded by wait(). All loads are
+    //!          in permille of the period, values above 1000 indicate an overflow. A period of 0 has no load.
+    //! @{
+
+    //!
+    //! @brief return the load of the last period
+    //!
+    //! @return unsigned load in permille
+    //!
+    unsigned getLoad(void);
+
+    //!
+    //! @brief return the smoothed load (moving average, see setEwmaShift())
+    //!
+    //! @return unsigned load in permille
+    //!
+    unsigned getAvgLoad(void);
+
+    //!
+    //! @brief return the highest load within the last one or two load windows
+    //!
+    //! @return unsigned load in permille
+    //!
+    unsigned getPeakLoad(void);
+
+    //!
+    //! @brief return the time which can be added to the busy part before the intervall overflows
+    //! @details based on the peak load
+    //!
+    //! @return Period_t headroom in milliseconds, 0 if the intervall already overflows
+    //!
+    Period_t getHeadroom(void);
+
+    //!
+    //! @brief set the number of periods for the peak load
+    //!
+    //! @param periods length of the window, default 100
+    //!
+    void setLoadWindow(unsigned periods);
+
+    //! @}
+
+    #ifdef WITH_INTERVALL_ADAPTIVE
+    //! @name Adaptive period
+    //! @details In adaptive mode wait() stretches the period if the smoothed load stays above
+    //!          #INTERVALL_ADAPT_HIGH for #INTERVALL_ADAPT_HOLD periods and shrinks it again if the load stays
+    //!          below #INTERVALL_ADAPT_LOW for 4 * #INTERVALL_ADAPT_HOLD periods. The new period aims at a load of
+    //!          #INTERVALL_ADAPT_TARGET, a shrinking period changes by at most 1/8 per step.
+    //! @note add -DWITH_INTERVALL_ADAPTIVE to your compiler flags to include the adaptive period
+    //! @{
+
+    //!
+    //! @brief enable the adaptive period
+    //! @details the current period is clamped into [minPeriod, maxPeriod]
+    //!
+    //! @param minPeriod shortest period in milliseconds
+    //! @param maxPeriod longest period in milliseconds
+    //! @param onChange if not NULL, called with the new period after each change
+    //!
+    void setAdaptive(Period_t minPeriod, Period_t maxPeriod, PeriodCallback_t onChange = NULL);
+
+    //!
+    //! @brief disable the adaptive period, the current period is kept
+    //!
+    void disableAdaptive(void);
+
+    //!
+    //! @brief return the number of period changes in adaptive mode
+    //!
+    //! @return unsigned
+    //!
+    unsigned getPeriodChanges(void);
+
+    //! @}
+    #endif
+
+    //! @name Statistics functions
+    //! @{
+
     //!
     //! @brief reset max/min/average statistics
     //!
@@ -120,19 +449,142 @@ class Intervall {
     //! @brief show all statistics
     //!
     void printStatistics(void);
+
+    //!
+    //! @brief return the number of overflows and overruns since the last reset
+    //!
+    //! @return unsigned
+    //!
+    unsigned getOverruns(void);
+    //! @}
+
+#endif
+
+#ifdef WITH_INTERVALL_REGISTRY
+
+    //! @name Registry
+    //! @details Registered intervalls are linked into a list, which is used to report the timing of the whole
+    //!          system. No memory is allocated, each intervall needs two pointers.
+    //! @note add -DWITH_INTERVALL_REGISTRY to your compiler flags to include the registry
+    //! @{
+
+    //!
+    //! @brief add the intervall to the registry
+    //! @details registering an already registered intervall only changes its name
+    //!
+    //! @param newName name in the report, e.g. F("sensor"), may be NULL
+    //!
+    void registerAs(const __FlashStringHelper* newName);
+
+    //!
+    //! @brief remove the intervall from the registry
+    //!
+    void unregister(void);
+
+    //!
+    //! @brief return the name given in registerAs()
+    //!
+    //! @return const __FlashStringHelper* NULL if there is no name
+    //!
+    const __FlashStringHelper* getName(void);
+
+    //!
+    //! @brief return the most recently registered intervall
+    //!
+    //! @return Intervall* NULL if the registry is empty
+    //!
+    static Intervall* getFirst(void);
+
+    //!
+    //! @brief return the next registered intervall
+    //!
+    //! @return Intervall* NULL at the end of the registry
+    //!
+    Intervall* getNext(void);
+
+    //!
+    //! @brief print a table with the timing of all registered intervalls
+    //!
+    static void printReport(void);
+
+    //!
+    //! @brief reset the statistics of all registered intervalls at once
+    //! @details interrupts are disabled meanwhile, so all statistics cover the same time span
+    //!
+    static void resetAllStatistics(void);
     //! @}
 
 #endif
 
   private:
+    //!
+    //! @brief first part of wait(): check initialization, collect statistics and detect overflows
+    //!
+    //! @return Success if the rest of the period has to be waited for, Overflow or Failure otherwise
+    //!
+    Result_t startWait(void);
+
+    //!
+    //! @brief report an overflow or overrun
+    //!
+    //! @param duration actual duration
+    //!
+    void reportOverrun(Period_t duration);
+
+    //!
+    //! @brief start the first period at time now, shortened by the phase offset
+    //!
+    //! @param now start time in milliseconds
+    //!
+    void start(unsigned long now);
+
+#ifdef WITH_INTERVALL_ADAPTIVE
+    //!
+    //! @brief adapt the period to the smoothed load
+    //!
+    void adaptPeriod(void);
+#endif
+
     Period_t      period;    //!< current period
     unsigned long timeStamp; //!< recorded timestamp with begin()
+    Period_t      phase;     //!< phase offset
+    Period_t      skew;      //!< part of the first period skipped due to the phase offset
+
+#ifdef WITH_INTERVALL_TRACE
+    friend class HardwareIntervall;
+
+    uint8_t id; //!< id in trace events
+
+    static uint8_t                                        nextId; //!< id of the next constructed intervall
+    static RingBuffer<TraceEvent_t, INTERVALL_TRACE_SIZE> trace;  //!< overrun events
+#endif
 
 #ifndef WITHOUT_INTERVALL_STATS
     // used for statistics
-    Period_t      maxPeriod;  //!< longest recorded period
-    Period_t      minPeriod;  //!< shortest recorded period
-    unsigned      sumPeriods; //!< total time in wait()
-    unsigned long numPeriods; //!< nubver of calls to wait()
+    RunningStatistics statistics; //!< min/max/mean/variance of the time until wait()
+
+    // used for the load
+    Period_t lastBusy;       //!< busy time of the last period
+    Period_t windowPeak;     //!< longest busy time in the current window
+    Period_t lastWindowPeak; //!< longest busy time in the previous window
+    unsigned windowCount;    //!< number of periods in the current window
+    unsigned loadWindow;     //!< number of periods per window
+
+    unsigned overruns; //!< number of overflows and overruns
+#endif
+
+#ifdef WITH_INTERVALL_ADAPTIVE
+    Period_t         adaptMin;       //!< shortest adaptive period, 0 = adaptive mode disabled
+    Period_t         adaptMax;       //!< longest adaptive period
+    int16_t          adaptCount;     //!< > 0 consecutive overloaded, < 0 consecutive underloaded periods
+    unsigned         periodChanges;  //!< number of adaptions
+    PeriodCallback_t onPeriodChange; //!< called after an adaption
+#endif
+
+#ifdef WITH_INTERVALL_REGISTRY
+    const __FlashStringHelper* name; //!< name in the report
+    Intervall*                 next; //!< next registered intervall
+
+    static Intervall* first; //!< most recently registered intervall
 #endif
 };
\ No newline at end of file
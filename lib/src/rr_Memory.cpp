@@ -0,0 +1,285 @@
+//!
+//! @file rr_Memory.cpp
+//! @author M. Nickels
+//! @brief free RAM, heap fragmentation and stack high water mark at runtime
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Memory.h"
+
+#if defined(ARDUINO_ARCH_RP2040) || (!defined(ARDUINO) && defined(__GLIBC__))
+    #include <malloc.h>
+    #include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------------------------------------------------------
+// painted window below the stack frame of begin()
+// ----------------------------------------------------------------------------------------------------------------
+
+#if !defined(ARDUINO_ARCH_AVR) && !defined(ARDUINO_ARCH_ESP32) && !defined(ARDUINO_ARCH_ESP8266)
+
+//! @brief lowest painted byte, stored as integer because the area is out of scope after the painting
+static uintptr_t stackBottom = 0;
+
+//! @brief paint RR_MEMORY_STACK_PAINT bytes below the frame of the caller
+static void __attribute__((noinline)) paintStack(void) {
+    volatile uint8_t area[RR_MEMORY_STACK_PAINT];
+
+    for (size_t index = 0; index < sizeof(area); index++)
+        area[index] = RR_MEMORY_CANARY;
+
+    stackBottom = (uintptr_t)area;
+}
+
+//! @brief count the unused bytes from the bottom of the painted area
+static size_t unusedStack(void) {
+    const volatile uint8_t* area  = (const volatile uint8_t*)stackBottom;
+    size_t                  count = 0;
+
+    if (area == NULL)
+        return 0;
+
+    while (count < RR_MEMORY_STACK_PAINT && area[count] == RR_MEMORY_CANARY)
+        count++;
+
+    return count;
+}
+
+#endif
+
+// ----------------------------------------------------------------------------------------------------------------
+// platform specific implementations
+// ----------------------------------------------------------------------------------------------------------------
+
+#if defined(ARDUINO_ARCH_AVR)
+
+//! @brief entry of the free list of malloc() in avr-libc
+struct FreeChunk {
+    size_t     size; //!< usable bytes
+    FreeChunk* next; //!< next entry, NULL at the end
+};
+
+extern "C" {
+extern char       __heap_start; //!< start of the heap (linker)
+extern char*      __brkval;     //!< end of the heap, NULL before the first malloc()
+extern FreeChunk* __flp;        //!< free list of malloc()
+}
+
+//! @brief paint the whole RAM above .bss before main(), the stack pointer is not set up yet
+extern "C" void paintStackAtStartup(void) __attribute__((naked, used, section(".init1")));
+
+extern "C" void paintStackAtStartup(void) {
+    __asm__ volatile("    ldi r30, lo8(_end)\n"
+                     "    ldi r31, hi8(_end)\n"
+                     "    ldi r24, %0\n"
+                     "    ldi r25, hi8(__stack)\n"
+                     "    rjmp 2f\n"
+                     "1:  st Z+, r24\n"
+                     "2:  cpi r30, lo8(__stack)\n"
+                     "    cpc r31, r25\n"
+                     "    brlo 1b\n"
+                     "    breq 1b\n" ::"M"(RR_MEMORY_CANARY));
+}
+
+//! @brief current end of the heap
+static inline uint8_t* heapEnd(void) {
+    return (uint8_t*)(__brkval != NULL ? __brkval : &__heap_start);
+}
+
+//! @brief current stack pointer, the next push goes here
+static inline uint8_t* stackPointer(void) {
+    return (uint8_t*)SP;
+}
+
+//! @brief block, which can be allocated between heap and stack
+//! @details malloc() keeps __malloc_margin bytes to the stack and needs a size field
+static size_t gapBlock(void) {
+    size_t gap = stackPointer() - heapEnd();
+
+    return gap > __malloc_margin + sizeof(size_t) ? gap - __malloc_margin - sizeof(size_t) : 0;
+}
+
+//! @brief gap between heap and stack plus the free list
+static size_t freeRam(void) {
+    size_t bytes = gapBlock();
+
+    for (FreeChunk* chunk = __flp; chunk != NULL; chunk = chunk->next)
+        bytes += chunk->size;
+
+    return bytes;
+}
+
+//! @brief the gap or the largest chunk of the free list
+static size_t largestBlock(void) {
+    size_t largest = gapBlock();
+
+    for (FreeChunk* chunk = __flp; chunk != NULL; chunk = chunk->next) {
+        if (chunk->size > largest)
+            largest = chunk->size;
+    }
+
+    return largest;
+}
+
+//! @brief paint between heap and stack, the margin protects the frame of memset()
+static void paintStack(void) {
+    uint8_t* start = heapEnd();
+    uint8_t* end   = stackPointer() - 16;
+
+    if (end > start)
+        memset(start, RR_MEMORY_CANARY, end - start);
+}
+
+//! @brief count the unused bytes above the heap
+static size_t unusedStack(void) {
+    const uint8_t* byte  = heapEnd();
+    const uint8_t* end   = stackPointer();
+    size_t         count = 0;
+
+    while (byte < end && *byte++ == RR_MEMORY_CANARY)
+        count++;
+
+    return count;
+}
+
+#elif defined(ARDUINO_ARCH_ESP32)
+
+//! @brief free heap of all regions
+static size_t freeRam(void) {
+    return ESP.getFreeHeap();
+}
+
+//! @brief largest block of the default heap
+static size_t largestBlock(void) {
+    return ESP.getMaxAllocHeap();
+}
+
+//! @brief FreeRTOS paints the stack of each task at its creation
+static void paintStack(void) {
+}
+
+//! @brief unused stack of the current task in bytes
+static size_t unusedStack(void) {
+    return uxTaskGetStackHighWaterMark(NULL);
+}
+
+#elif defined(ARDUINO_ARCH_ESP8266)
+
+//! @brief free heap
+static size_t freeRam(void) {
+    return ESP.getFreeHeap();
+}
+
+//! @brief largest block of the heap
+static size_t largestBlock(void) {
+    return ESP.getMaxFreeBlockSize();
+}
+
+//! @brief the core paints the stack of loop(), repaint its unused part
+static void paintStack(void) {
+    ESP.resetFreeContStack();
+}
+
+//! @brief unused stack of loop() in bytes
+static size_t unusedStack(void) {
+    return ESP.getFreeContStack();
+}
+
+#elif defined(ARDUINO_ARCH_RP2040)
+
+extern "C" char __StackLimit; //!< end of the heap (linker)
+
+//! @brief gap between the end of the heap and its limit
+static size_t heapGap(void) {
+    char* top = (char*)sbrk(0);
+
+    return top < &__StackLimit ? &__StackLimit - top : 0;
+}
+
+//! @brief free chunks inside the heap and the gap to its limit
+static size_t freeRam(void) {
+    return mallinfo().fordblks + heapGap();
+}
+
+//! @brief newlib does not report its largest free chunk
+static size_t largestBlock(void) {
+    return heapGap();
+}
+
+#elif !defined(ARDUINO) && defined(__GLIBC__)
+
+//! @brief free chunks inside the heap
+static size_t freeRam(void) {
+    #if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+    return mallinfo2().fordblks;
+    #else
+    return mallinfo().fordblks;
+    #endif
+}
+
+//! @brief glibc does not report its largest free chunk, the heap grows on demand
+static size_t largestBlock(void) {
+    return freeRam();
+}
+
+#else
+
+//! @brief unknown platform
+static size_t freeRam(void) {
+    return 0;
+}
+
+//! @brief unknown platform
+static size_t largestBlock(void) {
+    return 0;
+}
+
+#endif
+
+// ----------------------------------------------------------------------------------------------------------------
+
+void MemoryInfo::begin(void) {
+    paintStack();
+}
+
+size_t MemoryInfo::getFreeRam(void) {
+    return freeRam();
+}
+
+size_t MemoryInfo::getLargestBlock(void) {
+    return largestBlock();
+}
+
+uint8_t MemoryInfo::getFragmentation(void) {
+    size_t total   = freeRam();
+    size_t largest = largestBlock();
+
+    if (total == 0 || largest >= total)
+        return 0;
+
+    // keep the product in 32 bit for large heaps
+    while (total > 0xFFFFFFUL) {
+        total >>= 1;
+        largest >>= 1;
+    }
+
+    return 100 - (uint8_t)((uint32_t)largest * 100 / (uint32_t)total);
+}
+
+size_t MemoryInfo::getStackHighWater(void) {
+    return unusedStack();
+}
+
+void MemoryInfo::print(void) {
+    PRINT_INFO("Memory: Free: %lu  Largest: %lu  Fragmentation: %u%%  Stack: %lu", (unsigned long)getFreeRam(),
+               (unsigned long)getLargestBlock(), getFragmentation(), (unsigned long)getStackHighWater());
+}
@@ -0,0 +1,119 @@
+//!
+//! @file rr_Memory.h
+//! @author M. Nickels
+//! @brief free RAM, heap fragmentation and stack high water mark at runtime
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_DebugUtils.h"
+
+//!
+//! @brief byte pattern of the unused stack
+//!
+#ifndef RR_MEMORY_CANARY
+    #define RR_MEMORY_CANARY 0xC5
+#endif
+
+//!
+//! @brief size of the painted stack in bytes on platforms without known stack limits (RP2040, native)
+//! @note The value must be smaller than the free stack when begin() is called.
+//!
+#ifndef RR_MEMORY_STACK_PAINT
+    #define RR_MEMORY_STACK_PAINT 1024
+#endif
+
+//!
+//! @brief memory usage at runtime
+//! @details All queries are cheap enough to be called periodically from loop(). The stack high water mark scans
+//!          the painted stack from its bottom up to the first used byte, the time is proportional to the
+//!          returned value.
+//!
+//!          | Platform  | Free RAM / largest block                 | Stack high water mark                        |
+//!          | --------- | ---------------------------------------- | -------------------------------------------- |
+//!          | AVR       | gap between heap and stack and free list | painted before main() and by begin()         |
+//!          | ESP32     | ESP.getFreeHeap(), ESP.getMaxAllocHeap() | uxTaskGetStackHighWaterMark() of loop()      |
+//!          | ESP8266   | ESP.getFreeHeap(), getMaxFreeBlockSize() | ESP.getFreeContStack()                       |
+//!          | RP2040    | mallinfo() and the gap to __StackLimit   | RR_MEMORY_STACK_PAINT bytes below begin()    |
+//!          | native    | mallinfo() of glibc, free = largest      | RR_MEMORY_STACK_PAINT bytes below begin()    |
+//!
+//!          On AVR the free RAM includes the chunks on the free list of malloc(). A block must keep
+//!          __malloc_margin bytes distance to the stack, which is subtracted from the free RAM and the largest
+//!          block. The high water
+//!          mark is the number of bytes between the heap and the deepest stack, which have never been used by
+//!          either of them.
+//!
+//!          On RP2040 the largest block is the gap between the heap and its limit, larger free chunks inside the
+//!          heap are not found.
+//!
+//!          @code
+//!          void setup() {
+//!              MemoryInfo::begin();
+//!          }
+//!
+//!          void loop() {
+//!              if (report.isPeriodOver())
+//!                  PRINT_MEMORY();
+//!          }
+//!          @endcode
+//!
+class MemoryInfo {
+
+  public:
+    //!
+    //! @brief paint the unused stack with RR_MEMORY_CANARY and reset the high water mark
+    //! @details Call it early in setup(). On AVR the stack is already painted before main(), a call is only
+    //!          needed to reset the high water mark.
+    //!
+    static void begin(void);
+
+    //!
+    //! @brief return the free RAM
+    //!
+    //! @return size_t bytes
+    //!
+    static size_t getFreeRam(void);
+
+    //!
+    //! @brief return the largest block, which can be allocated
+    //!
+    //! @return size_t bytes
+    //!
+    static size_t getLargestBlock(void);
+
+    //!
+    //! @brief return the fragmentation of the free RAM
+    //!
+    //! @return uint8_t percent, 0 = the whole free RAM can be allocated as one block
+    //!
+    static uint8_t getFragmentation(void);
+
+    //!
+    //! @brief return the smallest free stack since the stack has been painted
+    //!
+    //! @return size_t bytes, 0 if the stack is exhausted or has not been painted
+    //!
+    static size_t getStackHighWater(void);
+
+    //!
+    //! @brief print all values, use PRINT_MEMORY()
+    //!
+    static void print(void);
+};
+
+#ifdef __PLATFORMIO_BUILD_DEBUG__
+    //! @brief print free RAM, largest block, fragmentation and the stack high water mark
+    #define PRINT_MEMORY() MemoryInfo::print()
+#else
+    #define PRINT_MEMORY()
+#endif
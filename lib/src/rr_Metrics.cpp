@@ -0,0 +1,243 @@
+//!
+//! @file rr_Metrics.cpp
+//! @author M. Nickels
+//! @brief counters, gauges and timers for telemetry with periodic export
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Metrics.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+portMUX_TYPE MetricLock::spinlock = portMUX_INITIALIZER_UNLOCKED;
+#elif !defined(ARDUINO_ARCH_AVR) && !defined(ARDUINO_ARCH_ESP8266) && !(defined(ARDUINO) && defined(__arm__))
+bool MetricLock::flag = false;
+#endif
+
+Metric* Metric::first = NULL;
+
+Metric::Metric(const __FlashStringHelper* newName, Type_t newType) {
+    name  = newName;
+    type  = newType;
+    last  = 0;
+    next  = first;
+    first = this;
+}
+
+Metric::~Metric() {
+    for (Metric** link = &first; *link != NULL; link = &(*link)->next) {
+        if (*link == this) {
+            *link = next;
+            break;
+        }
+    }
+}
+
+const __FlashStringHelper* Metric::getName(void) {
+    return name;
+}
+
+Metric::Type_t Metric::getType(void) {
+    return type;
+}
+
+void Metric::snapshot(Snapshot_t& snapshot) {
+    snapshot.average = 0;
+    snapshot.max     = 0;
+
+    switch (type) {
+    case Counter: {
+        MetricCounter* counter = static_cast<MetricCounter*>(this);
+
+        snapshot.value = counter->get();
+        break;
+    }
+    case Gauge: {
+        MetricGauge* gauge = static_cast<MetricGauge*>(this);
+
+        snapshot.value = (uint32_t)gauge->get();
+        break;
+    }
+    case Timer: {
+        MetricTimer* timer = static_cast<MetricTimer*>(this);
+        uint32_t     total;
+
+        {
+            MetricLock lock;
+
+            snapshot.value = timer->count;
+            snapshot.max   = timer->max;
+            total          = timer->total;
+            timer->max     = 0;
+        }
+
+        if (snapshot.value != last)
+            snapshot.average = (total - timer->lastTotal) / (snapshot.value - last);
+
+        timer->lastTotal = total;
+        break;
+    }
+    }
+
+    // the difference of two wrapping values is correct for counters and gauges
+    snapshot.delta = (int32_t)(snapshot.value - last);
+    last           = snapshot.value;
+}
+
+Metric* Metric::getNext(void) {
+    return next;
+}
+
+Metric* Metric::getFirst(void) {
+    return first;
+}
+
+uint8_t Metric::getCount(void) {
+    uint8_t count = 0;
+
+    for (Metric* metric = first; metric != NULL; metric = metric->next)
+        count++;
+
+    return count;
+}
+
+MetricsExporter::MetricsExporter(Print& newSink, Intervall& newIntervall, Format_t newFormat)
+    : sink(newSink), intervall(newIntervall) {
+    format   = newFormat;
+    sequence = 0;
+    checksum = 0;
+}
+
+bool MetricsExporter::poll(void) {
+    if (intervall.poll() == Intervall::NotDue)
+        return false;
+
+    write();
+
+    return true;
+}
+
+void MetricsExporter::write(void) {
+    unsigned long now   = RR_MILLIS();
+    uint8_t       index = 0;
+
+    if (format == Binary) {
+        checksum = 0;
+
+        writeBinary('M', 1);
+        writeBinary(sequence, 1);
+        writeBinary(now, 4);
+        writeBinary(Metric::getCount(), 1);
+    }
+    else {
+        sink.write('@');
+        writeNumber(now);
+        sink.write(' ');
+        sink.write('#');
+        writeNumber(sequence);
+    }
+
+    for (Metric* metric = Metric::getFirst(); metric != NULL; metric = metric->getNext(), index++) {
+        Metric::Snapshot_t snapshot;
+
+        metric->snapshot(snapshot);
+
+        if (format == Binary) {
+            writeBinary(index, 1);
+            writeBinary(metric->getType(), 1);
+            writeBinary(snapshot.value, 4);
+            writeBinary(snapshot.delta, 4);
+
+            if (metric->getType() == Metric::Timer) {
+                writeBinary(snapshot.average, 4);
+                writeBinary(snapshot.max, 4);
+            }
+        }
+        else {
+            sink.write(' ');
+            sink.print(metric->getName());
+            sink.write('=');
+
+            if (metric->getType() == Metric::Gauge)
+                writeSigned((int32_t)snapshot.value, false);
+            else
+                writeNumber(snapshot.value);
+
+            writeSigned(snapshot.delta, true);
+
+            if (metric->getType() == Metric::Timer) {
+                sink.write('/');
+                writeNumber(snapshot.average);
+                sink.write('/');
+                writeNumber(snapshot.max);
+            }
+        }
+    }
+
+    if (format == Binary)
+        writeBinary((uint8_t)~checksum, 1);
+    else {
+        sink.write('\r');
+        sink.write('\n');
+    }
+
+    sequence++;
+}
+
+void MetricsExporter::writeNames(void) {
+    uint8_t index = 0;
+
+    for (Metric* metric = Metric::getFirst(); metric != NULL; metric = metric->getNext(), index++) {
+        writeNumber(index);
+        sink.write(' ');
+        sink.print(metric->getName());
+        sink.write('\r');
+        sink.write('\n');
+    }
+}
+
+void MetricsExporter::setFormat(Format_t newFormat) {
+    format = newFormat;
+}
+
+void MetricsExporter::writeBinary(uint32_t value, uint8_t bytes) {
+    for (uint8_t count = 0; count < bytes; count++) {
+        uint8_t data = value & 0xFF;
+
+        sink.write(data);
+        checksum += data;
+        value >>= 8;
+    }
+}
+
+void MetricsExporter::writeNumber(uint32_t value) {
+    char    digits[10];
+    uint8_t count = 0;
+
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0)
+        sink.write(digits[--count]);
+}
+
+void MetricsExporter::writeSigned(int32_t value, bool plus) {
+    if (value < 0)
+        sink.write('-');
+    else if (plus)
+        sink.write('+');
+
+    // the magnitude of INT32_MIN does not fit into int32_t
+    writeNumber(value < 0 ? 0UL - (uint32_t)value : (uint32_t)value);
+}
+
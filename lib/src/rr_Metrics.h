@@ -0,0 +1,518 @@
+//!
+//! @file rr_Metrics.h
+//! @author M. Nickels
+//! @brief counters, gauges and timers for telemetry with periodic export
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_Intervall.h"
+
+//!
+//! @brief critical section for the atomic variants of the metrics
+//! @details Interrupts are disabled on single core platforms, the ESP32 uses a spinlock and the native
+//!          environment an atomic flag. Sections may not be nested.
+//!
+class MetricLock {
+
+  public:
+    //! @brief enter the critical section
+    MetricLock() {
+#if defined(ARDUINO_ARCH_AVR)
+        state = SREG;
+        cli();
+#elif defined(ARDUINO_ARCH_ESP8266)
+        state = xt_rsil(15);
+#elif defined(ARDUINO_ARCH_ESP32)
+        portENTER_CRITICAL_SAFE(&spinlock);
+#elif defined(ARDUINO) && defined(__arm__)
+        __asm__ volatile("mrs %0, primask\n cpsid i" : "=r"(state)::"memory");
+#else
+        while (__atomic_test_and_set(&flag, __ATOMIC_ACQUIRE)) {
+        }
+#endif
+    }
+
+    //! @brief leave the critical section
+    ~MetricLock() {
+#if defined(ARDUINO_ARCH_AVR)
+        SREG = state;
+#elif defined(ARDUINO_ARCH_ESP8266)
+        xt_wsr_ps(state);
+#elif defined(ARDUINO_ARCH_ESP32)
+        portEXIT_CRITICAL_SAFE(&spinlock);
+#elif defined(ARDUINO) && defined(__arm__)
+        __asm__ volatile("msr primask, %0" ::"r"(state) : "memory");
+#else
+        __atomic_clear(&flag, __ATOMIC_RELEASE);
+#endif
+    }
+
+  private:
+#if defined(ARDUINO_ARCH_AVR)
+    uint8_t state; //!< saved status register
+#elif defined(ARDUINO_ARCH_ESP8266) || (defined(ARDUINO) && defined(__arm__))
+    uint32_t state; //!< saved interrupt level
+#elif defined(ARDUINO_ARCH_ESP32)
+    static portMUX_TYPE spinlock; //!< lock of all metrics
+#else
+    static bool flag; //!< lock of all metrics
+#endif
+};
+
+//!
+//! @brief common part of all metrics
+//! @details Each metric registers itself in a list, which is read by MetricsExporter. No memory is allocated.
+//!          The metrics have no virtual functions, the type selects the implementation.
+//!
+class Metric {
+
+  public:
+    //!
+    //! @brief kind of metric
+    //!
+    typedef enum {
+        Counter = 0, //!< monotonic count of events
+        Gauge,       //!< current value, e.g. a queue depth
+        Timer        //!< number, average and maximum of durations
+    } Type_t;
+
+    //!
+    //! @brief values of a metric at an export
+    //!
+    typedef struct {
+        uint32_t value;   //!< counter: count, gauge: value as int32_t, timer: number of durations
+        int32_t  delta;   //!< change of value since the previous export
+        uint32_t average; //!< timer: average duration since the previous export in microseconds
+        uint32_t max;     //!< timer: longest duration since the previous export in microseconds
+    } Snapshot_t;
+
+    //!
+    //! @brief Construct a new Metric object and register it
+    //!
+    //! @param newName name, e.g. F("messages")
+    //! @param newType kind of metric
+    //!
+    Metric(const __FlashStringHelper* newName, Type_t newType);
+
+    //!
+    //! @brief Destroy the Metric object and remove it from the list
+    //!
+    ~Metric();
+
+    //!
+    //! @brief return the name
+    //!
+    //! @return const __FlashStringHelper*
+    //!
+    const __FlashStringHelper* getName(void);
+
+    //!
+    //! @brief return the kind of metric
+    //!
+    //! @return Metric::Type_t
+    //!
+    Type_t getType(void);
+
+    //!
+    //! @brief take the values and start the next export period
+    //! @details Each metric should be exported by only one MetricsExporter, otherwise the deltas are split.
+    //!
+    //! @param snapshot the values
+    //!
+    void snapshot(Snapshot_t& snapshot);
+
+    //!
+    //! @brief return the next metric
+    //!
+    //! @return Metric* NULL at the end of the list
+    //!
+    Metric* getNext(void);
+
+    //!
+    //! @brief return the first metric, the last one constructed
+    //!
+    //! @return Metric* NULL if there are no metrics
+    //!
+    static Metric* getFirst(void);
+
+    //!
+    //! @brief return the number of metrics
+    //!
+    //! @return uint8_t
+    //!
+    static uint8_t getCount(void);
+
+  protected:
+    uint32_t last; //!< value at the previous export
+
+  private:
+    const __FlashStringHelper* name; //!< name in the export
+    Type_t                     type; //!< kind of metric
+    Metric*                    next; //!< next metric in the list
+
+    static Metric* first; //!< first metric in the list
+};
+
+//!
+//! @brief monotonic count of events, wraps around at 2^32
+//!
+class MetricCounter : public Metric {
+
+  public:
+    //!
+    //! @brief Construct a new Metric Counter object
+    //!
+    //! @param newName name, e.g. F("messages")
+    //!
+    MetricCounter(const __FlashStringHelper* newName) : Metric(newName, Counter) {
+        value = 0;
+    }
+
+    //!
+    //! @brief count events, not interrupt safe
+    //!
+    //! @param count number of events
+    //!
+    void add(uint32_t count = 1) {
+        value = value + count;
+    }
+
+    //!
+    //! @brief count events, safe in interrupts and if interrupts count the same metric
+    //!
+    //! @param count number of events
+    //!
+    void addAtomic(uint32_t count = 1) {
+        MetricLock lock;
+
+        value = value + count;
+    }
+
+    //!
+    //! @brief return the number of events
+    //!
+    //! @return uint32_t
+    //!
+    uint32_t get(void) {
+        MetricLock lock;
+
+        return value;
+    }
+
+  private:
+    friend class Metric;
+
+    volatile uint32_t value; //!< number of events
+};
+
+//!
+//! @brief current value, e.g. a queue depth
+//!
+class MetricGauge : public Metric {
+
+  public:
+    //!
+    //! @brief Construct a new Metric Gauge object
+    //!
+    //! @param newName name, e.g. F("queue")
+    //!
+    MetricGauge(const __FlashStringHelper* newName) : Metric(newName, Gauge) {
+        value = 0;
+    }
+
+    //!
+    //! @brief set the value, not interrupt safe
+    //!
+    //! @param newValue the value
+    //!
+    void set(int32_t newValue) {
+        value = newValue;
+    }
+
+    //!
+    //! @brief change the value, not interrupt safe
+    //!
+    //! @param change the change
+    //!
+    void add(int32_t change) {
+        value = value + change;
+    }
+
+    //!
+    //! @brief set the value, safe in interrupts
+    //!
+    //! @param newValue the value
+    //!
+    void setAtomic(int32_t newValue) {
+        MetricLock lock;
+
+        value = newValue;
+    }
+
+    //!
+    //! @brief change the value, safe in interrupts
+    //!
+    //! @param change the change
+    //!
+    void addAtomic(int32_t change) {
+        MetricLock lock;
+
+        value = value + change;
+    }
+
+    //!
+    //! @brief return the value
+    //!
+    //! @return int32_t
+    //!
+    int32_t get(void) {
+        MetricLock lock;
+
+        return value;
+    }
+
+  private:
+    friend class Metric;
+
+    volatile int32_t value; //!< current value
+};
+
+//!
+//! @brief number, average and maximum of durations
+//!
+class MetricTimer : public Metric {
+
+  public:
+    //!
+    //! @brief Construct a new Metric Timer object
+    //!
+    //! @param newName name, e.g. F("loop")
+    //!
+    MetricTimer(const __FlashStringHelper* newName) : Metric(newName, Timer) {
+        count     = 0;
+        total     = 0;
+        max       = 0;
+        lastTotal = 0;
+    }
+
+    //!
+    //! @brief add a duration, not interrupt safe
+    //!
+    //! @param duration duration in microseconds
+    //!
+    void add(uint32_t duration) {
+        count = count + 1;
+        total = total + duration;
+
+        if (duration > max)
+            max = duration;
+    }
+
+    //!
+    //! @brief add a duration, safe in interrupts
+    //!
+    //! @param duration duration in microseconds
+    //!
+    void addAtomic(uint32_t duration) {
+        MetricLock lock;
+
+        add(duration);
+    }
+
+    //!
+    //! @brief add the time since a start
+    //!
+    //! @param start start in microseconds, e.g. RR_MICROS()
+    //!
+    void stop(unsigned long start) {
+        add(RR_MICROS() - start);
+    }
+
+    //!
+    //! @brief return the number of durations
+    //!
+    //! @return uint32_t
+    //!
+    uint32_t getCount(void) {
+        MetricLock lock;
+
+        return count;
+    }
+
+    //!
+    //! @brief return the longest duration since the previous export
+    //!
+    //! @return uint32_t microseconds
+    //!
+    uint32_t getMax(void) {
+        MetricLock lock;
+
+        return max;
+    }
+
+  private:
+    friend class Metric;
+
+    volatile uint32_t count;     //!< number of durations
+    volatile uint32_t total;     //!< sum of all durations in microseconds, wraps around
+    volatile uint32_t max;       //!< longest duration since the previous export
+    uint32_t          lastTotal; //!< total at the previous export
+};
+
+//!
+//! @brief measures the time from its construction to its destruction
+//!
+class MetricScope {
+
+  public:
+    //!
+    //! @brief Construct a new Metric Scope object and start the measurement
+    //!
+    //! @param newTimer the timer, which gets the duration
+    //!
+    MetricScope(MetricTimer& newTimer) : timer(newTimer) {
+        start = RR_MICROS();
+    }
+
+    //!
+    //! @brief Destroy the Metric Scope object and add the duration to the timer
+    //!
+    ~MetricScope() {
+        timer.stop(start);
+    }
+
+  private:
+    MetricTimer&  timer; //!< the timer
+    unsigned long start; //!< start of the measurement
+};
+
+//!
+//! @brief define a metric with a name in flash at file scope
+//! @details F() is only available in functions, the name is therefore placed in flash explicitly.
+//!
+//!          @code
+//!          METRIC(MetricCounter, messages, "messages");
+//!
+//!          void receive(void) {
+//!              messages.add();
+//!          }
+//!          @endcode
+//!
+#define METRIC(type, variable, name)                                                                                   \
+    static const char variable##Name[] PROGMEM = name;                                                                 \
+    type              variable(reinterpret_cast<const __FlashStringHelper*>(variable##Name))
+
+//!
+//! @brief writes all metrics periodically to a Print, e.g. Serial
+//! @details All output is written by Print::write(uint8_t) and the names by Print::print() without formatting
+//!          buffers. The text format is one line per export:
+//!
+//!          @code
+//!          @12000 #3 messages=1200+12 queue=3-1 loop=50+10/120/300
+//!          @endcode
+//!
+//!          Each export starts with the time in milliseconds and a sequence number. A counter or gauge shows its
+//!          value and the change since the previous export. A timer shows the number of durations, the change
+//!          of this number, the average and the maximum duration in microseconds since the previous export.
+//!
+//!          The binary format is a frame with little endian values:
+//!
+//!          | Bytes | Content                                                                   |
+//!          | ----- | ------------------------------------------------------------------------- |
+//!          | 1     | 'M'                                                                       |
+//!          | 1     | sequence number                                                           |
+//!          | 4     | time in milliseconds                                                      |
+//!          | 1     | number of records                                                         |
+//!          | 10    | per record: index in the list, Metric::Type_t, value, delta               |
+//!          | +8    | timer records: average and maximum                                        |
+//!          | 1     | checksum: sum of all previous bytes of the frame, inverted                |
+//!
+//!          The index is the position in the list of Metric::getFirst(), the names are written by
+//!          writeNames().
+//!
+class MetricsExporter {
+
+  public:
+    //!
+    //! @brief export format
+    //!
+    typedef enum {
+        Text = 0, //!< one line of text
+        Binary    //!< binary frame
+    } Format_t;
+
+    //!
+    //! @brief Construct a new Metrics Exporter object
+    //!
+    //! @param newSink destination of the export
+    //! @param newIntervall period of the export
+    //! @param newFormat export format
+    //!
+    MetricsExporter(Print& newSink, Intervall& newIntervall, Format_t newFormat = Text);
+
+    //!
+    //! @brief export all metrics if the period of the intervall is over, call it from loop()
+    //!
+    //! @return true if the metrics have been exported
+    //!
+    bool poll(void);
+
+    //!
+    //! @brief export all metrics now
+    //!
+    void write(void);
+
+    //!
+    //! @brief write the index and name of all metrics as text, one line per metric
+    //!
+    void writeNames(void);
+
+    //!
+    //! @brief change the export format
+    //!
+    //! @param newFormat export format
+    //!
+    void setFormat(Format_t newFormat);
+
+  private:
+    //!
+    //! @brief write a value of the binary format
+    //!
+    //! @param value the value
+    //! @param bytes number of bytes, little endian
+    //!
+    void writeBinary(uint32_t value, uint8_t bytes);
+
+    //!
+    //! @brief write an unsigned number as text
+    //!
+    //! @param value the number
+    //!
+    void writeNumber(uint32_t value);
+
+    //!
+    //! @brief write a signed number as text
+    //!
+    //! @param value the number
+    //! @param plus true to write '+' in front of positive numbers
+    //!
+    void writeSigned(int32_t value, bool plus);
+
+    Print&     sink;      //!< destination of the export
+    Intervall& intervall; //!< period of the export
+    Format_t   format;    //!< export format
+    uint8_t    sequence;  //!< number of the export
+    uint8_t    checksum;  //!< sum of the bytes of the binary frame
+};
@@ -0,0 +1,230 @@
+//!
+//! @file rr_MockI2CBus.cpp
+//! @author M. Nickels
+//! @brief simulated I2C bus for unit tests without hardware
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_MockI2CBus.h"
+
+MockI2CBus::MockI2CBus() {
+    memset(devices, 0, sizeof(devices));
+    memset(dataNaks, 0, sizeof(dataNaks));
+    memset(errors, 0, sizeof(errors));
+    memset(timeouts, 0, sizeof(timeouts));
+
+    stuck    = false;
+    clock    = 100000UL;
+    latency  = 0;
+    target   = 0;
+    written  = 0;
+    received = 0;
+    consumed = 0;
+
+    resetStatistics();
+}
+
+void MockI2CBus::addDevice(uint8_t address) {
+    setI2CPresent(devices, address, true);
+}
+
+void MockI2CBus::removeDevice(uint8_t address) {
+    setI2CPresent(devices, address, false);
+}
+
+void MockI2CBus::setFault(uint8_t address, uint8_t error) {
+    setI2CPresent(dataNaks, address, error == 3);
+    setI2CPresent(errors, address, error == 4);
+    setI2CPresent(timeouts, address, error == 5);
+
+    // a NAK on the address is an absent device
+    if (error == 2)
+        removeDevice(address);
+}
+
+bool MockI2CBus::setRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    RegisterFile* file = find(address);
+
+    if (file == NULL) {
+        RegisterFile empty;
+
+        memset(&empty, 0, sizeof(empty));
+        empty.address = address;
+
+        // NULL if all register files are used
+        file = registers.add(empty);
+
+        if (file == NULL)
+            return false;
+    }
+
+    file->data[reg] = value;
+
+    return true;
+}
+
+uint8_t MockI2CBus::getRegister(uint8_t address, uint8_t reg) {
+    RegisterFile* file = find(address);
+
+    return file != NULL ? file->data[reg] : 0;
+}
+
+void MockI2CBus::setStuck(bool newStuck) {
+    stuck = newStuck;
+}
+
+bool MockI2CBus::isStuck(void) {
+    return stuck;
+}
+
+void MockI2CBus::setLatency(unsigned long us) {
+    latency = us;
+}
+
+unsigned long MockI2CBus::getTransactions(void) {
+    return transactions;
+}
+
+unsigned long MockI2CBus::getBusyTime(void) {
+    return busyTime;
+}
+
+void MockI2CBus::resetStatistics(void) {
+    transactions = 0;
+    busyTime     = 0;
+}
+
+void MockI2CBus::begin(void) {
+}
+
+void MockI2CBus::end(void) {
+}
+
+void MockI2CBus::setClock(uint32_t frequency) {
+    if (frequency > 0)
+        clock = frequency;
+}
+
+void MockI2CBus::beginTransmission(uint8_t newAddress) {
+    target  = newAddress;
+    written = 0;
+}
+
+size_t MockI2CBus::write(uint8_t data) {
+    if (written >= MOCK_I2C_BUFFER_LENGTH)
+        return 0;
+
+    buffer[written++] = data;
+
+    return 1;
+}
+
+size_t MockI2CBus::write(const uint8_t* data, size_t quantity) {
+    size_t count = 0;
+
+    while (count < quantity && write(data[count]) == 1)
+        count++;
+
+    return count;
+}
+
+uint8_t MockI2CBus::endTransmission(bool) {
+    uint8_t       error = answer(target);
+    RegisterFile* file  = find(target);
+
+    // the transaction ends with the first NAK
+    transfer(error == 0 || error == 3 ? 1 + written : 1);
+
+    if (error == 3 && written == 0)
+        error = 0;
+
+    if (error == 0 && file != NULL && written > 0) {
+        file->pointer = buffer[0];
+
+        for (uint8_t index = 1; index < written; index++)
+            file->data[file->pointer++] = buffer[index];
+    }
+
+    return error;
+}
+
+uint8_t MockI2CBus::requestFrom(uint8_t address, uint8_t quantity, bool) {
+    RegisterFile* file  = find(address);
+    uint8_t       error = answer(address);
+
+    if (quantity > MOCK_I2C_BUFFER_LENGTH)
+        quantity = MOCK_I2C_BUFFER_LENGTH;
+
+    consumed = 0;
+
+    // the master acknowledges the data of a read, a NAK on data only affects writes
+    if (error != 0 && error != 3) {
+        transfer(1);
+        received = 0;
+    }
+    else {
+        transfer(1 + quantity);
+        received = quantity;
+
+        for (uint8_t index = 0; index < quantity; index++)
+            buffer[index] = file != NULL ? file->data[file->pointer++] : 0;
+    }
+
+    return received;
+}
+
+int MockI2CBus::available(void) {
+    return received - consumed;
+}
+
+int MockI2CBus::read(void) {
+    if (consumed >= received)
+        return -1;
+
+    return buffer[consumed++];
+}
+
+MockI2CBus::RegisterFile* MockI2CBus::find(uint8_t address) {
+    for (RegisterFile& file : registers) {
+        if (file.address == address)
+            return &file;
+    }
+
+    return NULL;
+}
+
+uint8_t MockI2CBus::answer(uint8_t address) {
+    if (stuck || isI2CPresent(errors, address))
+        return 4;
+    if (isI2CPresent(timeouts, address))
+        return 5;
+    if (!isI2CPresent(devices, address))
+        return 2;
+    if (isI2CPresent(dataNaks, address))
+        return 3;
+
+    return 0;
+}
+
+void MockI2CBus::transfer(uint16_t bytes) {
+    // 8 data bits and the acknowledge, rounded to microseconds
+    unsigned long us = latency + ((uint32_t)bytes * 9 * 1000000UL + clock / 2) / clock;
+
+    transactions++;
+    busyTime += us;
+
+#ifdef RR_VIRTUAL_CLOCK
+    VirtualClock::delayMicroseconds(us);
+#else
+    delayMicroseconds(us);
+#endif
+}
@@ -0,0 +1,265 @@
+//!
+//! @file rr_MockI2CBus.h
+//! @author M. Nickels
+//! @brief simulated I2C bus for unit tests without hardware
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_Containers.h"
+#include "rr_scanI2C.h"
+
+#define MOCK_I2C_REGISTER_FILES 4  //!< devices with registers
+#define MOCK_I2C_BUFFER_LENGTH  32 //!< bytes per transaction, as TwoWire on AVR
+
+//!
+//! @brief simulated I2C bus with the interface of TwoWire
+//! @details Devices answer with their address or with a configured error. Every transaction takes the
+//!          configured latency plus 9 bit times per byte (address and data) at the bus clock. With
+//!          RR_VIRTUAL_CLOCK the time passes on the VirtualClock, otherwise the transaction busy waits.
+//!
+//!          Up to MOCK_I2C_REGISTER_FILES devices have 256 registers. The first written byte of a transaction
+//!          sets the register pointer, further bytes are written to the registers, reads start at the
+//!          pointer. The pointer increments after every byte. Other devices read as 0.
+//!
+//!          @code
+//!          MockI2CBus bus;
+//!
+//!          bus.addDevice(0x3C);
+//!          bus.setFault(0x50, 4);
+//!          scanI2C(bus, map);
+//!          @endcode
+//!
+class MockI2CBus {
+
+  public:
+    //!
+    //! @brief Construct a new MockI2CBus object without devices at 100 kHz
+    //!
+    MockI2CBus();
+
+    //!
+    //! @name configuration of the simulation
+    //! @{
+
+    //!
+    //! @brief add a device
+    //!
+    //! @param address I2C address
+    //!
+    void addDevice(uint8_t address);
+
+    //!
+    //! @brief remove a device
+    //!
+    //! @param address I2C address
+    //!
+    void removeDevice(uint8_t address);
+
+    //!
+    //! @brief set the result of endTransmission() for an address
+    //!
+    //! @param address I2C address
+    //! @param error 0 = no fault, 2 = NAK on address, 3 = NAK on data, 4 = other error, 5 = timeout
+    //!
+    void setFault(uint8_t address, uint8_t error);
+
+    //!
+    //! @brief simulate a bus, which is blocked by a device holding SDA low
+    //! @details all transactions fail with error 4 until the bus is released
+    //!
+    //! @param stuck true to block the bus
+    //!
+    void setStuck(bool stuck);
+
+    //!
+    //! @brief check if the bus is blocked
+    //!
+    //! @return true if blocked
+    //!
+    bool isStuck(void);
+
+    //!
+    //! @brief set a register of a device
+    //! @details the first MOCK_I2C_REGISTER_FILES devices, which have registers set, get a register file
+    //!
+    //! @param address I2C address
+    //! @param reg register
+    //! @param value new content
+    //! @return true if the device has a register file
+    //!
+    bool setRegister(uint8_t address, uint8_t reg, uint8_t value);
+
+    //!
+    //! @brief return a register of a device
+    //!
+    //! @param address I2C address
+    //! @param reg register
+    //! @return uint8_t content, 0 if the device has no register file
+    //!
+    uint8_t getRegister(uint8_t address, uint8_t reg);
+
+    //!
+    //! @brief set the fixed time of a transaction, which is added to the bit times
+    //!
+    //! @param us microseconds
+    //!
+    void setLatency(unsigned long us);
+
+    //!
+    //! @brief return the number of transactions
+    //!
+    //! @return unsigned long
+    //!
+    unsigned long getTransactions(void);
+
+    //!
+    //! @brief return the simulated time of all transactions
+    //!
+    //! @return unsigned long microseconds
+    //!
+    unsigned long getBusyTime(void);
+
+    //!
+    //! @brief clear the transaction counters
+    //!
+    void resetStatistics(void);
+
+    //! @}
+
+    //!
+    //! @name interface of TwoWire
+    //! @{
+
+    //! @brief start the bus
+    void begin(void);
+
+    //! @brief stop the bus
+    void end(void);
+
+    //!
+    //! @brief set the bus clock
+    //!
+    //! @param frequency clock in Hz
+    //!
+    void setClock(uint32_t frequency);
+
+    //!
+    //! @brief start a write transaction
+    //!
+    //! @param address I2C address
+    //!
+    void beginTransmission(uint8_t address);
+
+    //!
+    //! @brief queue a byte for the transaction
+    //!
+    //! @param data the byte
+    //! @return size_t 1, 0 if the buffer is full
+    //!
+    size_t write(uint8_t data);
+
+    //!
+    //! @brief queue bytes for the transaction
+    //!
+    //! @param data the bytes
+    //! @param quantity number of bytes
+    //! @return size_t number of queued bytes
+    //!
+    size_t write(const uint8_t* data, size_t quantity);
+
+    //!
+    //! @brief execute the write transaction
+    //!
+    //! @param sendStop ignored
+    //! @return uint8_t 0 = success, 2 = NAK on address, 3 = NAK on data, 4 = other error, 5 = timeout
+    //!
+    uint8_t endTransmission(bool sendStop = true);
+
+    //!
+    //! @brief execute a read transaction
+    //!
+    //! @param address I2C address
+    //! @param quantity number of bytes, at most MOCK_I2C_BUFFER_LENGTH
+    //! @param sendStop ignored
+    //! @return uint8_t number of received bytes, 0 if the device did not answer
+    //!
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+
+    //!
+    //! @brief return the number of received bytes, which have not been read
+    //!
+    //! @return int
+    //!
+    int available(void);
+
+    //!
+    //! @brief return the next received byte
+    //!
+    //! @return int the byte, -1 if none is available
+    //!
+    int read(void);
+
+    //! @}
+
+  private:
+    //!
+    //! @brief registers of a device
+    //!
+    struct RegisterFile {
+        uint8_t address;   //!< I2C address
+        uint8_t pointer;   //!< register pointer
+        uint8_t data[256]; //!< registers
+    };
+
+    //!
+    //! @brief find the register file of a device
+    //!
+    //! @param address I2C address
+    //! @return RegisterFile* NULL if the device has no register file
+    //!
+    RegisterFile* find(uint8_t address);
+
+    //!
+    //! @brief result of the address phase
+    //!
+    //! @param address I2C address
+    //! @return uint8_t 0 = acknowledged, otherwise the error of endTransmission()
+    //!
+    uint8_t answer(uint8_t address);
+
+    //!
+    //! @brief let the time of a transaction pass
+    //!
+    //! @param bytes number of bytes including the address
+    //!
+    void transfer(uint16_t bytes);
+
+    I2CMap_t      devices;      //!< present devices
+    I2CMap_t      dataNaks;     //!< devices, which do not acknowledge data
+    I2CMap_t      errors;       //!< devices, which cause error 4
+    I2CMap_t      timeouts;     //!< devices, which cause a timeout
+    bool          stuck;        //!< the bus is blocked
+    uint32_t      clock;        //!< bus clock in Hz
+    unsigned long latency;      //!< fixed time of a transaction in microseconds
+    unsigned long transactions; //!< number of transactions
+    unsigned long busyTime;     //!< time of all transactions in microseconds
+    uint8_t       target;       //!< address of the current write transaction
+    uint8_t       written;      //!< bytes of the current write transaction
+    uint8_t       received;     //!< bytes of the last read transaction
+    uint8_t       consumed;     //!< bytes of the last read transaction, which have been read
+
+    uint8_t                                            buffer[MOCK_I2C_BUFFER_LENGTH]; //!< bytes of the transaction
+    StaticVector<RegisterFile, MOCK_I2C_REGISTER_FILES> registers;                     //!< register files
+};
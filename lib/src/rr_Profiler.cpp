@@ -0,0 +1,160 @@
+//!
+//! @file rr_Profiler.cpp
+//! @author M. Nickels
+//! @brief measure the execution time of code sections
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_DebugUtils.h"
+#include "rr_Profiler.h"
+
+ProfileSite*  ProfileSite::first    = NULL;
+unsigned long ProfileSite::offset   = 0;
+unsigned long ProfileSite::overhead = 0;
+
+ProfileSite::ProfileSite(const __FlashStringHelper* newName) {
+    name  = newName;
+    total = 0;
+    next  = first;
+    first = this;
+}
+
+ProfileSite::~ProfileSite() {
+    for (ProfileSite** link = &first; *link != NULL; link = &(*link)->next) {
+        if (*link == this) {
+            *link = next;
+            break;
+        }
+    }
+}
+
+void ProfileSite::add(unsigned long duration) {
+    duration = duration > offset ? duration - offset : 0;
+
+    statistics.add(duration);
+    total += duration;
+}
+
+const __FlashStringHelper* ProfileSite::getName(void) {
+    return name;
+}
+
+unsigned long ProfileSite::getCount(void) {
+    return statistics.getCount();
+}
+
+uint64_t ProfileSite::getTotal(void) {
+    return total;
+}
+
+unsigned long ProfileSite::getMin(void) {
+    return statistics.getMin();
+}
+
+unsigned long ProfileSite::getMax(void) {
+    return statistics.getMax();
+}
+
+unsigned long ProfileSite::getAvg(void) {
+    return statistics.getMean();
+}
+
+void ProfileSite::reset(void) {
+    statistics.reset();
+    total = 0;
+}
+
+ProfileSite* ProfileSite::getNext(void) {
+    return next;
+}
+
+ProfileSite* ProfileSite::getFirst(void) {
+    return first;
+}
+
+void ProfileSite::printReport(void) {
+    ProfileSite* sorted = NULL;
+    uint64_t     sum    = 0;
+
+    // insertion sort of the list by descending total time
+    while (first != NULL) {
+        ProfileSite*  site = first;
+        ProfileSite** link = &sorted;
+
+        first = site->next;
+
+        while (*link != NULL && (*link)->total >= site->total)
+            link = &(*link)->next;
+
+        site->next = *link;
+        *link      = site;
+        sum += site->total;
+    }
+
+    first = sorted;
+
+#ifdef __PLATFORMIO_BUILD_DEBUG__
+    unsigned tabs[] = {40, 56, 66, 76, 84, 92, 100};
+
+    Debug.setTabs(tabs, sizeof(tabs) / sizeof(tabs[0]));
+#endif
+
+    PRINT_INFO("Section\tCalls\tTotal ms\tShare\tMin\tMax\tAvg", NULL);
+
+    for (ProfileSite* site = first; site != NULL; site = site->next) {
+        unsigned share = sum > 0 ? (unsigned)(site->total * 1000 / sum) : 0;
+
+        PRINT_INFO(RR_FLASH_FMT "\t%lu\t%lu\t%u.%u%%\t%lu\t%lu\t%lu", reinterpret_cast<const char*>(site->name),
+                   site->getCount(), (unsigned long)(site->total / 1000), share / 10, share % 10, site->getMin(),
+                   site->getMax(), site->getAvg());
+    }
+
+#ifdef __PLATFORMIO_BUILD_DEBUG__
+    Debug.clearTabs();
+#endif
+
+    PRINT_INFO("Profiler overhead: %lu us per section, %lu us subtracted from each measurement", overhead,
+               offset);
+}
+
+void ProfileSite::resetAll(void) {
+    for (ProfileSite* site = first; site != NULL; site = site->next)
+        site->reset();
+}
+
+unsigned long ProfileSite::calibrate(unsigned loops) {
+    ProfileSite   empty(NULL);
+    unsigned long sum = 0;
+
+    offset = 0;
+
+    for (unsigned loop = 0; loop < loops; loop++) {
+        unsigned long start = RR_MICROS();
+
+        {
+            ProfileScope scope(empty);
+        }
+
+        sum += RR_MICROS() - start;
+    }
+
+    // an empty section measures the part of the profiler between reading the start and the end time,
+    // the outer measurement is the time the profiler adds to the program
+    offset   = empty.getAvg();
+    overhead = loops > 0 ? sum / loops : 0;
+
+    return overhead;
+}
+
+unsigned long ProfileSite::getOverhead(void) {
+    return overhead;
+}
@@ -0,0 +1,199 @@
+//!
+//! @file rr_Profiler.h
+//! @author M. Nickels
+//! @brief measure the execution time of code sections
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_Statistics.h"
+
+//!
+//! @brief timing record of a profiled code section
+//! @details Each PROFILE_SCOPE() creates one static record, which registers itself in a list the first time
+//!          the section is executed. No memory is allocated.
+//!
+class ProfileSite {
+
+  public:
+    //!
+    //! @brief Construct a new Profile Site object and register it
+    //!
+    //! @param newName name in the report, e.g. F("filter")
+    //!
+    ProfileSite(const __FlashStringHelper* newName);
+
+    //!
+    //! @brief Destroy the Profile Site object and remove it from the list
+    //!
+    ~ProfileSite();
+
+    //!
+    //! @brief add the duration of one execution
+    //! @details the time measured by an empty section (see calibrate()) is subtracted
+    //!
+    //! @param duration duration in microseconds
+    //!
+    void add(unsigned long duration);
+
+    //!
+    //! @brief return the name
+    //!
+    //! @return const __FlashStringHelper*
+    //!
+    const __FlashStringHelper* getName(void);
+
+    //!
+    //! @brief return the number of executions
+    //!
+    //! @return unsigned long
+    //!
+    unsigned long getCount(void);
+
+    //!
+    //! @brief return the sum of all durations
+    //!
+    //! @return uint64_t microseconds
+    //!
+    uint64_t getTotal(void);
+
+    //!
+    //! @brief return the shortest duration
+    //!
+    //! @return unsigned long microseconds
+    //!
+    unsigned long getMin(void);
+
+    //!
+    //! @brief return the longest duration
+    //!
+    //! @return unsigned long microseconds
+    //!
+    unsigned long getMax(void);
+
+    //!
+    //! @brief return the average duration
+    //!
+    //! @return unsigned long microseconds
+    //!
+    unsigned long getAvg(void);
+
+    //!
+    //! @brief forget all executions
+    //!
+    void reset(void);
+
+    //!
+    //! @brief return the next site, the order is given by the last call of printReport()
+    //!
+    //! @return ProfileSite* NULL at the end of the list
+    //!
+    ProfileSite* getNext(void);
+
+    //!
+    //! @brief return the first site
+    //!
+    //! @return ProfileSite* NULL if no profiled section has been executed
+    //!
+    static ProfileSite* getFirst(void);
+
+    //!
+    //! @brief sort all sites by descending total time and print them as a table
+    //!
+    static void printReport(void);
+
+    //!
+    //! @brief reset all sites
+    //!
+    static void resetAll(void);
+
+    //!
+    //! @brief measure the overhead of an empty profiled section
+    //! @details The time an empty section measures is subtracted from all following measurements. Call this
+    //!          function once in setup(), before the sections to profile are executed.
+    //!
+    //! @param loops number of measurements to average
+    //! @return unsigned long time the profiler adds to each execution of a section in microseconds
+    //!
+    static unsigned long calibrate(unsigned loops = 100);
+
+    //!
+    //! @brief return the time the profiler adds to each execution of a section, measured by calibrate()
+    //!
+    //! @return unsigned long microseconds
+    //!
+    static unsigned long getOverhead(void);
+
+  private:
+    const __FlashStringHelper* name;       //!< name in the report
+    RunningStatistics          statistics; //!< count, min, max, average
+    uint64_t                   total;      //!< sum of all durations
+    ProfileSite*               next;       //!< next site in the list
+
+    static ProfileSite*  first;    //!< first site in the list
+    static unsigned long offset;   //!< time measured by an empty section
+    static unsigned long overhead; //!< time added to each section
+};
+
+//!
+//! @brief measures the time from its construction to its destruction
+//!
+class ProfileScope {
+
+  public:
+    //!
+    //! @brief Construct a new Profile Scope object and start the measurement
+    //!
+    //! @param site record of the section
+    //!
+    ProfileScope(ProfileSite& site) : site(site) {
+        start = RR_MICROS();
+    }
+
+    //!
+    //! @brief Destroy the Profile Scope object and add the duration to the site
+    //!
+    ~ProfileScope() {
+        site.add(RR_MICROS() - start);
+    }
+
+  private:
+    ProfileSite&  site;  //!< record of the section
+    unsigned long start; //!< start of the measurement
+};
+
+//! @cond
+#define RR_PROFILE_JOIN2(a, b) a##b
+#define RR_PROFILE_JOIN(a, b)  RR_PROFILE_JOIN2(a, b)
+//! @endcond
+
+//!
+//! @brief measure the execution time from this statement to the end of the enclosing block
+//! @details Only available in debug builds, add -DWITHOUT_PROFILER to your compiler flags to remove it
+//!          from debug builds as well. The name must be a string literal, it is stored in flash.
+//!
+//!          @code
+//!          void filter(void) {
+//!              PROFILE_SCOPE("filter");
+//!              ...
+//!          }
+//!          @endcode
+//!
+#if defined(__PLATFORMIO_BUILD_DEBUG__) && !defined(WITHOUT_PROFILER)
+    #define PROFILE_SCOPE(name)                                                                                        \
+        static ProfileSite RR_PROFILE_JOIN(profileSite, __LINE__)(F(name));                                            \
+        ProfileScope       RR_PROFILE_JOIN(profileScope, __LINE__)(RR_PROFILE_JOIN(profileSite, __LINE__))
+#else
+    #define PROFILE_SCOPE(name)
+#endif
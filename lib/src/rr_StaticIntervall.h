@@ -0,0 +1,276 @@
+//!
+//! @file rr_StaticIntervall.h
+//! @author M. Nickels
+//! @brief compile time specialized intervall with policy based statistics
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_DebugUtils.h"
+#include "rr_Intervall.h"
+#include "rr_Statistics.h"
+
+//!
+//! @name Clock policies
+//! @{
+
+//! @brief time base in milliseconds
+struct IntervallMillisClock {
+    //! @brief current time
+    static unsigned long now(void) {
+        return RR_MILLIS();
+    }
+};
+
+//! @brief time base in microseconds
+struct IntervallMicrosClock {
+    //! @brief current time
+    static unsigned long now(void) {
+        return RR_MICROS();
+    }
+};
+
+//! @}
+
+//!
+//! @name Statistics policies
+//! @{
+
+//! @brief no statistics at all, uses no RAM
+class IntervallNoStats {
+  public:
+    //! @brief record a period (nothing to do)
+    void addPeriod(Intervall::Period_t) {
+    }
+
+    //! @brief reset statistics (nothing to do)
+    void resetStatistics(void) {
+    }
+};
+
+//! @brief record shortest and longest period only
+class IntervallMinMaxStats {
+  public:
+    //! @brief Construct a new Intervall Min Max Stats object
+    IntervallMinMaxStats() {
+        resetStatistics();
+    }
+
+    //! @brief record a period
+    void addPeriod(Intervall::Period_t delta) {
+        if (delta < minPeriod)
+            minPeriod = delta;
+        if (delta > maxPeriod)
+            maxPeriod = delta;
+    }
+
+    //! @brief reset statistics
+    void resetStatistics(void) {
+        minPeriod = (Intervall::Period_t)-1;
+        maxPeriod = 0;
+    }
+
+    //! @brief return the mininum wait period
+    Intervall::Period_t getMinPeriod(void) {
+        return minPeriod;
+    }
+
+    //! @brief return the maximum wait period
+    Intervall::Period_t getMaxPeriod(void) {
+        return maxPeriod;
+    }
+
+  private:
+    Intervall::Period_t minPeriod; //!< shortest recorded period
+    Intervall::Period_t maxPeriod; //!< longest recorded period
+};
+
+//! @brief the same statistics as class Intervall
+class IntervallFullStats {
+  public:
+    //! @brief record a period
+    void addPeriod(Intervall::Period_t delta) {
+        statistics.add(delta);
+    }
+
+    //! @brief reset statistics
+    void resetStatistics(void) {
+        statistics.reset();
+    }
+
+    //! @brief return the mininum wait period
+    Intervall::Period_t getMinPeriod(void) {
+        return statistics.getMin();
+    }
+
+    //! @brief return the maximum wait period
+    Intervall::Period_t getMaxPeriod(void) {
+        return statistics.getMax();
+    }
+
+    //! @brief return the average wait period
+    Intervall::Period_t getAvgPeriod(void) {
+        return statistics.getMean();
+    }
+
+    //! @brief return the standard deviation of the wait period
+    Intervall::Period_t getStdDevPeriod(void) {
+        return statistics.getStdDev();
+    }
+
+    //! @brief return the moving average of the wait period
+    Intervall::Period_t getEwmaPeriod(void) {
+        return statistics.getEwma();
+    }
+
+  private:
+    RunningStatistics statistics; //!< min/max/mean/variance of the time until wait()
+};
+
+//!
+//! @brief histogram of the wait period
+//!
+//! @tparam Buckets number of buckets, the last bucket counts all longer periods
+//! @tparam Width width of a bucket in clock ticks
+//!
+template <uint8_t Buckets, Intervall::Period_t Width> class IntervallHistogramStats {
+  public:
+    //! @brief Construct a new Intervall Histogram Stats object
+    IntervallHistogramStats() {
+        resetStatistics();
+    }
+
+    //! @brief record a period
+    void addPeriod(Intervall::Period_t delta) {
+        Intervall::Period_t index = delta / Width;
+
+        if (index >= Buckets)
+            index = Buckets - 1;
+
+        // saturate instead of wrapping around
+        if (histogram[index] != (uint16_t)-1)
+            histogram[index]++;
+    }
+
+    //! @brief reset statistics
+    void resetStatistics(void) {
+        for (uint8_t loop = 0; loop < Buckets; loop++)
+            histogram[loop] = 0;
+    }
+
+    //! @brief return the number of periods in a bucket
+    uint16_t getBucket(uint8_t index) {
+        return index < Buckets ? histogram[index] : 0;
+    }
+
+  private:
+    uint16_t histogram[Buckets]; //!< number of periods per bucket
+};
+
+//! @}
+
+//!
+//! @brief intervall with a compile time period
+//! @details Same behaviour as class Intervall, but the period is a constant and the statistics are
+//!          selected per instance. With IntervallNoStats an instance only needs the time stamp.
+//!          The statistics functions of the policy are available as members of the intervall.
+//!
+//! @tparam Period period length in clock ticks
+//! @tparam Stats statistics policy (IntervallNoStats, IntervallMinMaxStats, IntervallFullStats,
+//!         IntervallHistogramStats)
+//! @tparam Clock clock policy (IntervallMillisClock, IntervallMicrosClock)
+//!
+template <Intervall::Period_t Period, class Stats = IntervallNoStats, class Clock = IntervallMillisClock>
+class StaticIntervall : public Stats {
+
+  public:
+    //!
+    //! @brief Construct a new Static Intervall object
+    //!
+    StaticIntervall() {
+        timeStamp = 0;
+    }
+
+    //!
+    //! @brief return the period length
+    //!
+    //! @return Intervall::Period_t
+    //!
+    static constexpr Intervall::Period_t getPeriod(void) {
+        return Period;
+    }
+
+    //!
+    //! @brief initialize an intervall.
+    //!
+    void begin(void) {
+        timeStamp = Clock::now();
+
+        // 0 marks an intervall, which has not begun, a later time stamp would lie in the future
+        if (timeStamp == 0)
+            timeStamp--;
+    }
+
+    //!
+    //! @brief check if current period is over
+    //!
+    //! @return true if current time >= planned time
+    //! @return false if current time < planned time
+    //!
+    bool isPeriodOver(void) {
+        return timeStamp == 0 || Clock::now() - timeStamp >= Period;
+    }
+
+    //!
+    //! @brief wait until the next intervall shall be started
+    //! @see Intervall::wait()
+    //!
+    //! @param userFunc if not null and this functions returns true, the intervall is aborted
+    //! @return result of the intervall
+    //!
+    Intervall::Result_t wait(bool (*userFunc)(void) = NULL) {
+        Intervall::Period_t delta  = Clock::now() - timeStamp;
+        Intervall::Result_t result = Intervall::Success;
+
+        if (timeStamp == 0) {
+            PRINT_ERROR("Intervall not initialized. Call begin() before wait()", NULL);
+            return Intervall::Failure;
+        }
+
+        Stats::addPeriod(delta);
+
+        if (delta < Period) {
+            while (!isPeriodOver()) {
+                if (userFunc != NULL && userFunc()) {
+                    result = Intervall::Abort;
+                    break;
+                }
+
+                RR_YIELD();
+            }
+        }
+        else {
+            PRINT_WARNING("Intervall overflow. Intervall: %u  current: %u", Period, delta);
+
+            result = Intervall::Overflow;
+        }
+
+        timeStamp = Clock::now();
+
+        return result;
+    }
+
+  private:
+    unsigned long timeStamp; //!< recorded timestamp with begin()
+};
@@ -0,0 +1,186 @@
+//!
+//! @file rr_Statistics.cpp
+//! @author M. Nickels
+//! @brief overflow free running statistics (min, max, mean, variance, EWMA)
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <limits.h>
+
+// own includes
+#include "rr_Statistics.h"
+
+//! number of fractional bits of mean and ewma
+#define FRACTION_BITS 8
+
+//! largest sample, which fits into Q23.8
+#define MAX_SAMPLE (INT32_MAX >> FRACTION_BITS)
+
+//! largest difference, whose square fits into int32_t
+#define MAX_DELTA 46340L
+
+//! @brief number of bits of a power of two
+static constexpr uint8_t bitsOf(unsigned long value) {
+    return value > 1 ? 1 + bitsOf(value >> 1) : 0;
+}
+
+static_assert((RR_STATISTICS_WINDOW & (RR_STATISTICS_WINDOW - 1)) == 0, "RR_STATISTICS_WINDOW must be a power of two");
+
+//! weight of a sample after the window is saturated, 2^WINDOW_BITS
+#define WINDOW_BITS bitsOf(RR_STATISTICS_WINDOW)
+
+//!
+//! @brief integer square root
+//!
+//! @param value the radicand
+//! @return uint32_t floor(sqrt(value))
+//!
+static uint32_t isqrt(uint32_t value) {
+    uint32_t result = 0;
+    uint32_t bit    = 1UL << 30;
+
+    while (bit > value)
+        bit >>= 2;
+
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+            result >>= 1;
+
+        bit >>= 2;
+    }
+
+    return result;
+}
+
+RunningStatistics::RunningStatistics() {
+    ewmaShift = 3;
+
+    reset();
+}
+
+void RunningStatistics::reset(void) {
+    minValue = ULONG_MAX;
+    maxValue = 0;
+    count    = 0;
+    mean     = 0;
+    variance = 0;
+    ewma     = 0;
+
+    meanRest     = 0;
+    varianceRest = 0;
+}
+
+void RunningStatistics::add(Value_t value) {
+    // larger values overflow the fixed point format, min and max are exact
+    int32_t sample = (int32_t)(value < MAX_SAMPLE ? value : MAX_SAMPLE) << FRACTION_BITS;
+
+    if (value < minValue)
+        minValue = value;
+    if (value > maxValue)
+        maxValue = value;
+
+    if (count < ULONG_MAX)
+        count++;
+
+    if (count == 1) {
+        mean         = sample;
+        variance     = 0;
+        ewma         = sample;
+        meanRest     = 0;
+        varianceRest = 0;
+    }
+    else {
+        // Welford's method with the weight 2^shift >= count, which saturates so that old samples fade out
+        uint8_t shift = WINDOW_BITS;
+        int32_t mask;
+        int32_t delta = sample - mean;
+        int32_t delta2;
+        int32_t step  = delta + meanRest;
+
+        if (count < RR_STATISTICS_WINDOW) {
+            shift = 0;
+
+            while ((1UL << shift) < count)
+                shift++;
+        }
+
+        mask = (1L << shift) - 1;
+
+        // the remainder of the shift is carried to the next sample, otherwise the mean stops moving as
+        // soon as |delta| < weight
+        mean += step >> shift;
+        meanRest = step & mask;
+        delta2   = sample - mean;
+
+        // delta * delta2 is Q16 and never negative, 64 bit arithmetic is only needed for large deviations
+        if (delta > -MAX_DELTA && delta < MAX_DELTA && delta2 > -MAX_DELTA && delta2 < MAX_DELTA &&
+            variance <= INT32_MAX / 2) {
+            int32_t diff = ((delta * delta2) >> FRACTION_BITS) - (int32_t)variance + varianceRest;
+
+            variance     = (int32_t)variance + (diff >> shift);
+            varianceRest = diff & mask;
+        }
+        else {
+            int64_t diff = (((int64_t)delta * delta2) >> FRACTION_BITS) - (int64_t)variance + varianceRest;
+            int64_t v    = variance + (diff >> shift);
+
+            varianceRest = (int32_t)(diff & mask);
+
+            if (v < 0)
+                variance = 0;
+            else if (v > (int64_t)UINT32_MAX)
+                variance = UINT32_MAX;
+            else
+                variance = v;
+        }
+
+        ewma += (sample - ewma) >> ewmaShift;
+    }
+}
+
+void RunningStatistics::setEwmaShift(uint8_t shift) {
+    ewmaShift = shift < 15 ? shift : 15;
+}
+
+unsigned long RunningStatistics::getCount(void) {
+    return count;
+}
+
+RunningStatistics::Value_t RunningStatistics::getMin(void) {
+    return minValue;
+}
+
+RunningStatistics::Value_t RunningStatistics::getMax(void) {
+    return maxValue;
+}
+
+RunningStatistics::Value_t RunningStatistics::getMean(void) {
+    return (mean + (1L << (FRACTION_BITS - 1))) >> FRACTION_BITS;
+}
+
+unsigned long RunningStatistics::getVariance(void) {
+    return (variance >> FRACTION_BITS) + ((variance >> (FRACTION_BITS - 1)) & 1);
+}
+
+RunningStatistics::Value_t RunningStatistics::getStdDev(void) {
+    // the root of a Q8 value is Q4
+    return (isqrt(variance) + (1 << (FRACTION_BITS / 2 - 1))) >> (FRACTION_BITS / 2);
+}
+
+RunningStatistics::Value_t RunningStatistics::getEwma(void) {
+    return (ewma + (1L << (FRACTION_BITS - 1))) >> FRACTION_BITS;
+}
+
+int32_t RunningStatistics::getEwmaFixed(void) {
+    return ewma;
+}
@@ -0,0 +1,133 @@
+//!
+//! @file rr_Statistics.h
+//! @author M. Nickels
+//! @brief overflow free running statistics (min, max, mean, variance, EWMA)
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <stdint.h>
+
+// own includes
+
+//!
+//! @brief number of samples after which the mean/variance turn into a sliding estimate
+//! @details Up to this number of samples the weight of a new sample is 1/2^n with 2^n >= number of samples
+//!          (Welford's method with power of two weights). Afterwards the weight stays at 1/RR_STATISTICS_WINDOW,
+//!          so the accumulator can run forever without overflow. Must be a power of two, all divisions are
+//!          shifts.
+//!
+#ifndef RR_STATISTICS_WINDOW
+    #define RR_STATISTICS_WINDOW 4096
+#endif
+
+//!
+//! @brief streaming statistics in integer/fixed point arithmetic
+//! @details Mean and EWMA are kept in Q23.8 fixed point, the variance in Q8 (unit²). All values are
+//!          bounded, therefore no sum can overflow regardless of the number of samples.
+//!          Mean, variance and EWMA treat values from 2^23 on as 2^23 - 1, minimum and maximum are exact.
+//!
+class RunningStatistics {
+
+  public:
+    typedef unsigned long Value_t; //!< type of a sample
+
+    //!
+    //! @brief Construct a new Running Statistics object
+    //!
+    RunningStatistics();
+
+    //!
+    //! @brief forget all samples
+    //!
+    void reset(void);
+
+    //!
+    //! @brief add a sample
+    //!
+    //! @param value the new sample
+    //!
+    void add(Value_t value);
+
+    //!
+    //! @brief set the time constant of the exponentially weighted moving average
+    //!
+    //! @param shift the time constant is 2^shift samples (0..15)
+    //!
+    void setEwmaShift(uint8_t shift);
+
+    //!
+    //! @brief return number of samples
+    //! @note saturates at ULONG_MAX
+    //!
+    //! @return unsigned long
+    //!
+    unsigned long getCount(void);
+
+    //!
+    //! @brief return the smallest sample
+    //!
+    //! @return RunningStatistics::Value_t, ULONG_MAX if there are no samples
+    //!
+    Value_t getMin(void);
+
+    //!
+    //! @brief return the largest sample
+    //!
+    //! @return RunningStatistics::Value_t
+    //!
+    Value_t getMax(void);
+
+    //!
+    //! @brief return the (rounded) mean of all samples
+    //!
+    //! @return RunningStatistics::Value_t
+    //!
+    Value_t getMean(void);
+
+    //!
+    //! @brief return the (rounded) population variance of all samples
+    //!
+    //! @return unsigned long
+    //!
+    unsigned long getVariance(void);
+
+    //!
+    //! @brief return the (rounded) standard deviation of all samples
+    //!
+    //! @return RunningStatistics::Value_t
+    //!
+    Value_t getStdDev(void);
+
+    //!
+    //! @brief return the (rounded) exponentially weighted moving average
+    //!
+    //! @return RunningStatistics::Value_t
+    //!
+    Value_t getEwma(void);
+
+    //!
+    //! @brief return the exponentially weighted moving average without rounding
+    //!
+    //! @return int32_t Q23.8 fixed point value
+    //!
+    int32_t getEwmaFixed(void);
+
+  private:
+    Value_t       minValue;     //!< smallest sample
+    Value_t       maxValue;     //!< largest sample
+    unsigned long count;        //!< number of samples
+    int32_t       mean;         //!< running mean, Q23.8
+    uint32_t      variance;     //!< running variance, Q8
+    int32_t       ewma;         //!< exponentially weighted moving average, Q23.8
+    int32_t       meanRest;     //!< remainder of the last division of mean
+    int32_t       varianceRest; //!< remainder of the last division of variance
+    uint8_t       ewmaShift;    //!< time constant of ewma
+};
@@ -0,0 +1,69 @@
+//!
+//! @file rr_Task.cpp
+//! @author M. Nickels
+//! @brief lightweight stackless tasks, which suspend on intervalls, delays or conditions
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+
+#include <limits.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_Task.h"
+
+TaskScheduler::TaskScheduler(TaskEntry_t newEntries[], uint8_t newCount) {
+    entries = newEntries;
+    count   = newCount;
+
+    for (uint8_t loop = 0; loop < count; loop++)
+        TASK_INIT(&entries[loop].task);
+}
+
+uint8_t TaskScheduler::run(void) {
+    uint8_t running = 0;
+
+    for (uint8_t loop = 0; loop < count; loop++) {
+        Task_t* task = &entries[loop].task;
+
+        if (task->line == TASK_FINISHED)
+            continue;
+
+        if (task->wakeUp == 0 || (long)(RR_MILLIS() - task->wakeUp) >= 0) {
+            if (entries[loop].func(task))
+                running++;
+        }
+        else
+            running++;
+    }
+
+    return running;
+}
+
+unsigned long TaskScheduler::getIdleTime(void) {
+    unsigned long now  = RR_MILLIS();
+    unsigned long idle = ULONG_MAX;
+
+    for (uint8_t loop = 0; loop < count; loop++) {
+        Task_t* task = &entries[loop].task;
+
+        if (task->line == TASK_FINISHED)
+            continue;
+
+        // tasks without wake up time are polled
+        if (task->wakeUp == 0 || (long)(now - task->wakeUp) >= 0)
+            return 0;
+
+        if (task->wakeUp - now < idle)
+            idle = task->wakeUp - now;
+    }
+
+    return idle;
+}
@@ -0,0 +1,352 @@
+//!
+//! @file rr_Task.h
+//! @author M. Nickels
+//! @brief lightweight stackless tasks, which suspend on intervalls, delays or conditions
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_Intervall.h"
+
+//!
+//! @brief state of a task (protothread)
+//! @details A suspended task only needs this structure, its local variables are lost while it is
+//!          suspended. Use static or global variables to keep values across a TASK_AWAIT...().
+//!
+typedef struct {
+    uint16_t      line;   //!< where to resume, 0 = start of the task
+    unsigned long wakeUp; //!< do not resume before this time (milliseconds), 0 = resume always
+} Task_t;
+
+//!
+//! @brief a task function
+//! @details The function body is enclosed in TASK_BEGIN() and TASK_END(). A `switch` statement must not
+//!          span an await.
+//!
+//! @return true while the task is running, false if it has finished
+//!
+typedef bool (*TaskFunc_t)(Task_t* task);
+
+//! @brief marks a finished task
+#define TASK_FINISHED 0xFFFF
+
+//!
+//! @name Task macros
+//! @{
+
+//! @brief initialize or restart a task
+#define TASK_INIT(task)                                                                                                \
+    do {                                                                                                               \
+        (task)->line   = 0;                                                                                            \
+        (task)->wakeUp = 0;                                                                                            \
+    } while (0)
+
+//! @brief start of the task body
+#define TASK_BEGIN(task)                                                                                               \
+    switch ((task)->line) {                                                                                            \
+    case 0:
+
+//! @brief end of the task body
+#define TASK_END(task)                                                                                                 \
+    }                                                                                                                  \
+    (task)->line   = TASK_FINISHED;                                                                                    \
+    (task)->wakeUp = 0;                                                                                                \
+    return false
+
+//! @brief suspend until the next call
+#define TASK_YIELD(task)                                                                                               \
+    do {                                                                                                               \
+        (task)->line = __LINE__;                                                                                       \
+        return true;                                                                                                   \
+    case __LINE__:;                                                                                                    \
+    } while (0)
+
+//! @brief suspend until condition is true
+#define TASK_AWAIT(task, condition)                                                                                    \
+    do {                                                                                                               \
+        (task)->line = __LINE__;                                                                                       \
+    case __LINE__:                                                                                                     \
+        if (!(condition))                                                                                              \
+            return true;                                                                                               \
+    } while (0)
+
+//! @brief suspend until the absolute time deadline (milliseconds) has passed
+#define TASK_AWAIT_UNTIL(task, deadline)                                                                               \
+    do {                                                                                                               \
+        (task)->wakeUp = (deadline) ? (deadline) : 1;                                                                  \
+        (task)->line   = __LINE__;                                                                                     \
+        return true;                                                                                                   \
+    case __LINE__:                                                                                                     \
+        if ((long)(RR_MILLIS() - (task)->wakeUp) < 0)                                                                  \
+            return true;                                                                                               \
+        (task)->wakeUp = 0;                                                                                            \
+    } while (0)
+
+//! @brief suspend for ms milliseconds, the deadline is computed once before the task suspends
+#define TASK_AWAIT_MS(task, ms)                                                                                        \
+    do {                                                                                                               \
+        (task)->wakeUp = RR_MILLIS() + (ms);                                                                           \
+        TASK_AWAIT_UNTIL(task, (task)->wakeUp);                                                                        \
+    } while (0)
+
+//! @brief suspend until the next period of an Intervall, which is polled by the task
+#define TASK_AWAIT_PERIOD(task, intervall)                                                                             \
+    do {                                                                                                               \
+        (task)->wakeUp = (intervall).getDeadline() ? (intervall).getDeadline() : 1;                                    \
+        (task)->line   = __LINE__;                                                                                     \
+        return true;                                                                                                   \
+    case __LINE__:                                                                                                     \
+        if ((long)(RR_MILLIS() - (task)->wakeUp) < 0 || (intervall).poll() == Intervall::NotDue)                       \
+            return true;                                                                                               \
+        (task)->wakeUp = 0;                                                                                            \
+    } while (0)
+
+//! @}
+
+//! @brief a task in the scheduler
+typedef struct {
+    TaskFunc_t func; //!< task function
+    Task_t     task; //!< state of the task
+} TaskEntry_t;
+
+//!
+//! @brief round robin scheduler for tasks
+//! @details The tasks are kept in an array provided by the caller. A task is only resumed if its
+//!          wake up time has passed.
+//!
+class TaskScheduler {
+
+  public:
+    //!
+    //! @brief Construct a new Task Scheduler object
+    //!
+    //! @param entries array of tasks, the task states are initialized
+    //! @param count number of tasks
+    //!
+    TaskScheduler(TaskEntry_t entries[], uint8_t count);
+
+    //!
+    //! @brief resume all due tasks once
+    //! @details call this function from loop()
+    //!
+    //! @return uint8_t number of tasks which have not finished
+    //!
+    uint8_t run(void);
+
+    //!
+    //! @brief return the time until the next task is due
+    //!
+    //! @return unsigned long milliseconds, 0 if a task is due
+    //!
+    unsigned long getIdleTime(void);
+
+  private:
+    TaskEntry_t* entries; //!< the tasks
+    uint8_t      count;   //!< number of tasks
+};
+
+#ifdef __cpp_impl_coroutine
+    #include <coroutine>
+
+//!
+//! @brief C++20 coroutine task
+//! @details Available if the toolchain supports coroutines (e.g. native or ESP32 with -std=gnu++20).
+//!          In contrast to the protothreads local variables survive a suspension, because they live
+//!          in the coroutine frame, which is allocated once when the task is created.
+//!
+//!          @code
+//!          CoTask blink(Intervall& intervall) {
+//!              for (;;) {
+//!                  co_await nextPeriod(intervall);
+//!                  ...
+//!              }
+//!          }
+//!          @endcode
+//!
+class CoTask {
+
+  public:
+    //! @brief coroutine promise
+    struct promise_type {
+        unsigned long wakeUp = 0;       //!< do not resume before this time, 0 = resume always
+        bool (*ready)(void*) = NULL;    //!< additional condition to resume
+        void* readyContext   = NULL;    //!< parameter of ready
+
+        //! @brief create the task object
+        CoTask get_return_object() {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        //! @brief the task runs on the first call of run()
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        //! @brief keep the frame until the task object is destroyed
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        //! @brief nothing to return
+        void return_void() {
+        }
+
+        //! @brief exceptions are not supported
+        void unhandled_exception() {
+        }
+    };
+
+    //! @brief awaitable for an absolute time
+    struct Sleep {
+        unsigned long deadline; //!< time in milliseconds
+
+        //! @brief check if suspension is necessary
+        bool await_ready() {
+            return (long)(RR_MILLIS() - deadline) >= 0;
+        }
+
+        //! @brief store the wake up time in the promise
+        void await_suspend(std::coroutine_handle<promise_type> handle) {
+            handle.promise().wakeUp = deadline ? deadline : 1;
+        }
+
+        //! @brief nothing to return
+        void await_resume() {
+        }
+    };
+
+    //! @brief awaitable for a condition
+    template <typename Predicate> struct Until {
+        Predicate predicate; //!< resume if predicate() returns true
+
+        //! @brief call the predicate
+        static bool check(void* self) {
+            return ((Until*)self)->predicate();
+        }
+
+        //! @brief check if suspension is necessary
+        bool await_ready() {
+            return predicate();
+        }
+
+        //! @brief store the condition in the promise
+        void await_suspend(std::coroutine_handle<promise_type> handle) {
+            handle.promise().ready        = check;
+            handle.promise().readyContext = this;
+        }
+
+        //! @brief nothing to return
+        void await_resume() {
+        }
+    };
+
+    //! @brief awaitable for the next period of an intervall
+    struct Period {
+        Intervall& intervall; //!< the intervall, which is polled
+
+        //! @brief poll the intervall
+        static bool check(void* self) {
+            return ((Period*)self)->intervall.poll() != Intervall::NotDue;
+        }
+
+        //! @brief check if suspension is necessary
+        bool await_ready() {
+            return check(this);
+        }
+
+        //! @brief store deadline and condition in the promise
+        void await_suspend(std::coroutine_handle<promise_type> handle) {
+            handle.promise().wakeUp       = intervall.getDeadline() ? intervall.getDeadline() : 1;
+            handle.promise().ready        = check;
+            handle.promise().readyContext = this;
+        }
+
+        //! @brief nothing to return
+        void await_resume() {
+        }
+    };
+
+    //!
+    //! @brief Construct a new Co Task object
+    //!
+    //! @param handle the coroutine
+    //!
+    explicit CoTask(std::coroutine_handle<promise_type> handle) : handle(handle) {
+    }
+
+    //! @brief tasks can be moved but not copied
+    CoTask(CoTask&& other) noexcept : handle(other.handle) {
+        other.handle = nullptr;
+    }
+
+    CoTask(const CoTask&)            = delete;
+    CoTask& operator=(const CoTask&) = delete;
+
+    //! @brief destroy the coroutine frame
+    ~CoTask() {
+        if (handle)
+            handle.destroy();
+    }
+
+    //!
+    //! @brief resume the task if it is due
+    //!
+    //! @return true while the task is running, false if it has finished
+    //!
+    bool run(void) {
+        promise_type& promise = handle.promise();
+
+        if (handle.done())
+            return false;
+
+        if (promise.wakeUp != 0 && (long)(RR_MILLIS() - promise.wakeUp) < 0)
+            return true;
+
+        if (promise.ready != NULL && !promise.ready(promise.readyContext))
+            return true;
+
+        promise.wakeUp = 0;
+        promise.ready  = NULL;
+
+        handle.resume();
+
+        return !handle.done();
+    }
+
+  private:
+    std::coroutine_handle<promise_type> handle; //!< the coroutine
+};
+
+//!
+//! @brief suspend for ms milliseconds
+//!
+inline CoTask::Sleep sleepFor(unsigned long ms) {
+    return CoTask::Sleep{RR_MILLIS() + ms};
+}
+
+//!
+//! @brief suspend until predicate() returns true
+//!
+template <typename Predicate> CoTask::Until<Predicate> until(Predicate predicate) {
+    return CoTask::Until<Predicate>{predicate};
+}
+
+//!
+//! @brief suspend until the next period of intervall
+//!
+inline CoTask::Period nextPeriod(Intervall& intervall) {
+    return CoTask::Period{intervall};
+}
+
+#endif
@@ -0,0 +1,197 @@
+//!
+//! @file rr_TimerWheel.cpp
+//! @author M. Nickels
+//! @brief hierarchical timing wheel for a large number of software timers
+//!
+//! This file is part of the Library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+// own includes
+#include "rr_TimerWheel.h"
+
+static_assert(TIMERWHEEL_BITS * TIMERWHEEL_LEVELS < 32, "timer wheel exceeds 32 bit ticks");
+
+//! number of slots per level
+#define SLOTS (1U << TIMERWHEEL_BITS)
+
+//! mask for the index within a level
+#define MASK (SLOTS - 1)
+
+//! longest possible delay
+#define MAX_DELAY ((1UL << (TIMERWHEEL_BITS * TIMERWHEEL_LEVELS)) - 1)
+
+TimerWheel::TimerWheel(Timer_t pool[], size_t poolSize, Tick_t now) {
+    for (uint8_t level = 0; level < TIMERWHEEL_LEVELS; level++)
+        for (unsigned index = 0; index < SLOTS; index++)
+            slots[level][index] = NULL;
+
+    freeList = NULL;
+
+    for (size_t loop = 0; loop < poolSize; loop++) {
+        pool[loop].callback = NULL;
+        link(&freeList, &pool[loop]);
+    }
+
+    current = now;
+    count   = 0;
+}
+
+void TimerWheel::link(Timer_t** head, Timer_t* timer) {
+    timer->next = *head;
+    if (timer->next)
+        timer->next->pprev = &timer->next;
+
+    timer->pprev = head;
+    *head        = timer;
+}
+
+void TimerWheel::unlink(Timer_t* timer) {
+    *timer->pprev = timer->next;
+    if (timer->next)
+        timer->next->pprev = timer->pprev;
+
+    timer->next  = NULL;
+    timer->pprev = NULL;
+}
+
+void TimerWheel::insert(Timer_t* timer) {
+    Tick_t delta = timer->expires - current;
+
+    // already due (only while cascading), expires in the current step
+    if ((int32_t)delta <= 0) {
+        link(&slots[0][current & MASK], timer);
+        return;
+    }
+
+    for (uint8_t level = 0; level < TIMERWHEEL_LEVELS; level++) {
+        if (delta < (1UL << (TIMERWHEEL_BITS * (level + 1)))) {
+            link(&slots[level][(timer->expires >> (TIMERWHEEL_BITS * level)) & MASK], timer);
+            return;
+        }
+    }
+}
+
+TimerWheel::Timer_t* TimerWheel::start(Tick_t delay, Callback_t callback, void* context, Tick_t interval) {
+    Timer_t* timer = freeList;
+
+    if (timer == NULL || callback == NULL)
+        return NULL;
+
+    unlink(timer);
+
+    // a delay of 0 would hit the slot, which has already been processed
+    if (delay == 0)
+        delay = 1;
+    else if (delay > MAX_DELAY)
+        delay = MAX_DELAY;
+
+    timer->expires  = current + delay;
+    timer->interval = interval > MAX_DELAY ? MAX_DELAY : interval;
+    timer->callback = callback;
+    timer->context  = context;
+
+    insert(timer);
+    count++;
+
+    return timer;
+}
+
+bool TimerWheel::stop(Timer_t* timer) {
+    if (timer == NULL || timer->callback == NULL)
+        return false;
+
+    unlink(timer);
+
+    timer->callback = NULL;
+    link(&freeList, timer);
+    count--;
+
+    return true;
+}
+
+void TimerWheel::cascade(uint8_t level, unsigned index) {
+    Timer_t* pending = NULL;
+
+    // detach the slot first, insert() may put timers back into the same slot
+    if (slots[level][index]) {
+        pending = slots[level][index];
+        slots[level][index] = NULL;
+        pending->pprev      = &pending;
+    }
+
+    while (pending) {
+        Timer_t* timer = pending;
+
+        unlink(timer);
+        insert(timer);
+    }
+}
+
+unsigned TimerWheel::step(void) {
+    Timer_t* pending = NULL;
+    unsigned expired = 0;
+    unsigned index;
+
+    current++;
+    index = current & MASK;
+
+    // entering a new round of a level: move the timers of the next coarser slot down
+    for (uint8_t level = 1; level < TIMERWHEEL_LEVELS && index == 0; level++) {
+        index = (current >> (TIMERWHEEL_BITS * level)) & MASK;
+        cascade(level, index);
+    }
+
+    index = current & MASK;
+
+    if (slots[0][index]) {
+        pending          = slots[0][index];
+        slots[0][index]  = NULL;
+        pending->pprev   = &pending;
+    }
+
+    // callbacks may stop pending timers, so always take the head of the list
+    while (pending) {
+        Timer_t*   timer    = pending;
+        Callback_t callback = timer->callback;
+        void*      context  = timer->context;
+
+        unlink(timer);
+
+        if (timer->interval) {
+            timer->expires += timer->interval;
+            insert(timer);
+        }
+        else {
+            timer->callback = NULL;
+            link(&freeList, timer);
+            count--;
+        }
+
+        expired++;
+        callback(context);
+    }
+
+    return expired;
+}
+
+unsigned TimerWheel::tick(Tick_t now) {
+    unsigned expired = 0;
+
+    while ((int32_t)(now - current) > 0)
+        expired += step();
+
+    return expired;
+}
+
+size_t TimerWheel::getCount(void) {
+    return count;
+}
+
+TimerWheel::Tick_t TimerWheel::getTime(void) {
+    return current;
+}
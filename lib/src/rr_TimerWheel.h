@@ -0,0 +1,159 @@
+//!
+//! @file rr_TimerWheel.h
+//! @author M. Nickels
+//! @brief hierarchical timing wheel for a large number of software timers
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// own includes
+
+//!
+//! @name Size of the wheel
+//! @details The wheel has TIMERWHEEL_LEVELS * 2^TIMERWHEEL_BITS slots, each a pointer. The longest delay
+//!          is 2^(TIMERWHEEL_LEVELS * TIMERWHEEL_BITS) - 1 ticks, e.g. 4.6 hours at 1ms per tick with
+//!          the defaults (65 seconds on AVR).
+//! @{
+
+#ifndef TIMERWHEEL_BITS
+    #ifdef ARDUINO_ARCH_AVR
+        #define TIMERWHEEL_BITS 4 //!< number of bits per wheel level
+    #else
+        #define TIMERWHEEL_BITS 6
+    #endif
+#endif
+
+#ifndef TIMERWHEEL_LEVELS
+    #define TIMERWHEEL_LEVELS 4 //!< number of wheel levels
+#endif
+
+//! @}
+
+//!
+//! @brief hierarchical timing wheel
+//! @details start(), stop() and the expiry of a timer are O(1). Timers far in the future are kept in the
+//!          coarser levels and cascade into the finer levels while the time advances. All timers are
+//!          taken from a pool provided by the caller, no memory is allocated.
+//!          The wheel does not read a clock itself, call tick() with the current time (e.g. millis()).
+//!
+class TimerWheel {
+
+  public:
+    typedef uint32_t Tick_t;                   //!< time in ticks
+    typedef void (*Callback_t)(void* context); //!< called when a timer expires
+
+    //! a timer, allocate an array of these and pass it to the constructor
+    typedef struct Timer_s {
+        struct Timer_s*  next;     //!< next timer in slot
+        struct Timer_s** pprev;    //!< pointer to the link pointing to this timer
+        Tick_t           expires;  //!< expiry time
+        Tick_t           interval; //!< period of periodic timers, 0 for one shot timers
+        Callback_t       callback; //!< callback, NULL if the timer is not in use
+        void*            context;  //!< parameter of the callback
+    } Timer_t;
+
+    //!
+    //! @brief Construct a new Timer Wheel object
+    //!
+    //! @param pool array of timers
+    //! @param poolSize number of timers in pool
+    //! @param now current time
+    //!
+    TimerWheel(Timer_t pool[], size_t poolSize, Tick_t now = 0);
+
+    //!
+    //! @brief start a timer
+    //!
+    //! @param delay ticks until the timer expires, at most 2^(levels * bits) - 1
+    //! @param callback called when the timer expires
+    //! @param context parameter of the callback
+    //! @param interval if not 0, the timer is restarted with this delay after it expired
+    //! @return Timer_t* handle of the timer, NULL if the pool is exhausted
+    //!
+    Timer_t* start(Tick_t delay, Callback_t callback, void* context = NULL, Tick_t interval = 0);
+
+    //!
+    //! @brief stop a running timer and return it to the pool
+    //!
+    //! @param timer handle returned by start()
+    //! @return true if the timer has been stopped
+    //! @return false if the timer was not running
+    //!
+    bool stop(Timer_t* timer);
+
+    //!
+    //! @brief advance the time and call the callbacks of all expired timers
+    //! @details Each elapsed tick costs O(1) plus the expired timers. Callbacks may start and stop timers.
+    //!
+    //! @param now current time
+    //! @return unsigned number of expired timers
+    //!
+    unsigned tick(Tick_t now);
+
+    //!
+    //! @brief return the number of running timers
+    //!
+    //! @return size_t
+    //!
+    size_t getCount(void);
+
+    //!
+    //! @brief return the current time of the wheel
+    //!
+    //! @return TimerWheel::Tick_t
+    //!
+    Tick_t getTime(void);
+
+  private:
+    //!
+    //! @brief insert a timer in the slot matching its expiry time
+    //!
+    //! @param timer the timer
+    //!
+    void insert(Timer_t* timer);
+
+    //!
+    //! @brief add a timer at the head of a list
+    //!
+    //! @param head the list
+    //! @param timer the timer
+    //!
+    static void link(Timer_t** head, Timer_t* timer);
+
+    //!
+    //! @brief remove a timer from its list
+    //!
+    //! @param timer the timer
+    //!
+    static void unlink(Timer_t* timer);
+
+    //!
+    //! @brief advance the time by one tick
+    //!
+    //! @return unsigned number of expired timers
+    //!
+    unsigned step(void);
+
+    //!
+    //! @brief move all timers of a slot into the finer levels
+    //!
+    //! @param level level of the slot
+    //! @param index index of the slot
+    //!
+    void cascade(uint8_t level, unsigned index);
+
+    Timer_t* slots[TIMERWHEEL_LEVELS][1 << TIMERWHEEL_BITS]; //!< lists of timers
+    Timer_t* freeList;                                       //!< unused timers
+    Tick_t   current;                                        //!< current time of the wheel
+    size_t   count;                                          //!< number of running timers
+};
@@ -22,6 +22,45 @@
 
 // own includes
 #include "rr_DebugUtils.h"
+#include "rr_I2CDevices.h"
+#include "rr_scanI2C.h"
+
+uint8_t countI2C(const I2CMap_t map) {
+    uint8_t count = 0;
+
+    for (uint8_t index = 0; index < sizeof(I2CMap_t); index++) {
+        // clear the lowest set bit until none is left
+        for (uint8_t bits = map[index]; bits != 0; bits &= bits - 1)
+            count++;
+    }
+
+    return count;
+}
+
+uint8_t scanI2C(I2CMap_t map, uint8_t first, uint8_t last, uint32_t clock) {
+    return scanI2C(Wire, map, first, last, clock);
+}
+
+void printI2C(const I2CMap_t map) {
+    uint8_t nDevices = 0;
+
+    for (uint8_t address = 0; address < 128; address++) {
+        if (isI2CPresent(map, address)) {
+#ifdef WITHOUT_I2C_NAMES
+            PRINT_INFO("I2C device 0x%x", address);
+#else
+            const __FlashStringHelper* names = lookupI2C(address);
+
+            PRINT_INFO("I2C device 0x%x: " RR_FLASH_FMT, address,
+                       reinterpret_cast<const char*>(names != NULL ? names : F("unknown")));
+#endif
+            nDevices++;
+        }
+    }
+
+    if (nDevices == 0)
+        PRINT_WARNING("No I2C devices found", NULL);
+}
 
 //!
 //! @brief scan I2C bus and show devices
@@ -29,31 +68,16 @@
 //! @return uint8_t number of found devices
 //!
 uint8_t scanI2C(void) {
-    byte    error, address; // variable for error and I2C address
-    uint8_t nDevices;
+    I2CMap_t map;
+    uint8_t  nDevices;
 
     PRINT_INFO("Scanning...", NULL);
 
-    nDevices = 0;
-    for (address = 1; address < 127; address++) {
-        // The i2c_scanner uses the return value of
-        // the Write.endTransmisstion to see if
-        // a device did acknowledge to the address.
-        Wire.beginTransmission(address);
-        error = Wire.endTransmission();
+    nDevices = scanI2C(map);
+    printI2C(map);
 
-        if (error == 0) {
-            PRINT_INFO("I2C device 0x%x", address);
-            nDevices++;
-        }
-        else if (error == 4) {
-            PRINT_WARNING("I2C error 0x%x", address);
-        }
-    }
-    if (nDevices == 0)
-        PRINT_WARNING("No I2C devices found", NULL);
-    else
+    if (nDevices > 0)
         PRINT_INFO("done", NULL);
 
     return nDevices;
-}
\ No newline at end of file
+}
@@ -0,0 +1,514 @@
+//!
+//! @file rr_scanI2C.h
+//! @author M. Nickels
+//! @brief scan an I2C bus for devices
+//! @details All functions and classes work on any bus object with the interface of TwoWire (e.g. Wire1 or
+//!          MockI2CBus). The variants without bus parameter use Wire.
+//!
+//! This file is part of the library "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// own includes
+#include "rr_Clock.h"
+#include "rr_DebugUtils.h"
+
+//!
+//! @name I2C address range
+//! @details The addresses 0x00-0x07 and 0x78-0x7F are reserved by the I2C specification (general call,
+//!          CBUS, high speed mode, 10 bit addressing) and are never probed.
+//! @{
+
+#define I2C_FIRST_ADDRESS 0x08 //!< lowest address of a device
+#define I2C_LAST_ADDRESS  0x77 //!< highest address of a device
+
+//! @}
+
+//!
+//! @brief presence bitmap of the 128 I2C addresses, bit (address % 8) of byte (address / 8)
+//!
+typedef uint8_t I2CMap_t[16];
+
+//!
+//! @brief check if a device is marked in the bitmap
+//!
+//! @param map the bitmap
+//! @param address I2C address
+//! @return true if the device is present
+//!
+inline bool isI2CPresent(const I2CMap_t map, uint8_t address) {
+    return address < 128 && (map[address >> 3] & (1 << (address & 7)));
+}
+
+//!
+//! @brief mark a device in the bitmap
+//!
+//! @param map the bitmap
+//! @param address I2C address
+//! @param present new state
+//!
+inline void setI2CPresent(I2CMap_t map, uint8_t address, bool present) {
+    if (address < 128) {
+        if (present)
+            map[address >> 3] |= 1 << (address & 7);
+        else
+            map[address >> 3] &= ~(1 << (address & 7));
+    }
+}
+
+//!
+//! @brief count the devices in the bitmap
+//!
+//! @param map the bitmap
+//! @return uint8_t number of devices
+//!
+uint8_t countI2C(const I2CMap_t map);
+
+//!
+//! @brief probe a single address
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @param bus the bus
+//! @param address I2C address
+//! @return true if a device acknowledged
+//!
+template <class Bus> bool probeI2C(Bus& bus, uint8_t address) {
+    // The i2c_scanner uses the return value of
+    // the Write.endTransmisstion to see if
+    // a device did acknowledge to the address.
+    bus.beginTransmission(address);
+
+    switch (bus.endTransmission()) {
+    case 0:
+        return true;
+    case 4:
+        PRINT_WARNING("I2C error 0x%x", address);
+        return false;
+    case 5:
+        PRINT_WARNING("I2C timeout 0x%x", address);
+        return false;
+    default:
+        return false;
+    }
+}
+
+//!
+//! @brief scan an I2C bus without printing
+//! @details Addresses outside of I2C_FIRST_ADDRESS ... I2C_LAST_ADDRESS are not probed. If clock is not 0, the
+//!          bus clock is set before the scan and stays set afterwards.
+//! @pre call bus.begin before calling this function
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//! @param bus the bus
+//! @param map bitmap, which receives the responding devices, addresses outside of the range are cleared
+//! @param first first address to probe
+//! @param last last address to probe
+//! @param clock bus clock in Hz for the scan (e.g. 100000, 400000 or 1000000), 0 = keep the current clock
+//! @return uint8_t number of found devices
+//!
+template <class Bus>
+uint8_t scanI2C(Bus& bus, I2CMap_t map, uint8_t first = I2C_FIRST_ADDRESS, uint8_t last = I2C_LAST_ADDRESS,
+                uint32_t clock = 0) {
+    uint8_t nDevices = 0;
+
+    memset(map, 0, sizeof(I2CMap_t));
+
+    if (first < I2C_FIRST_ADDRESS)
+        first = I2C_FIRST_ADDRESS;
+    if (last > I2C_LAST_ADDRESS)
+        last = I2C_LAST_ADDRESS;
+
+    if (clock != 0)
+        bus.setClock(clock);
+
+    for (uint16_t address = first; address <= last; address++) {
+        if (probeI2C(bus, address)) {
+            setI2CPresent(map, address, true);
+            nDevices++;
+        }
+    }
+
+    return nDevices;
+}
+
+//!
+//! @brief scan the I2C bus Wire without printing
+//! @pre call Wire.begin before calling this function
+//!
+//! @param map bitmap, which receives the responding devices, addresses outside of the range are cleared
+//! @param first first address to probe
+//! @param last last address to probe
+//! @param clock bus clock in Hz for the scan, 0 = keep the current clock
+//! @return uint8_t number of found devices
+//!
+uint8_t scanI2C(I2CMap_t map, uint8_t first = I2C_FIRST_ADDRESS, uint8_t last = I2C_LAST_ADDRESS,
+                uint32_t clock = 0);
+
+//!
+//! @brief print the devices of a bitmap with the candidates of lookupI2C()
+//! @note add -DWITHOUT_I2C_NAMES to your compiler flags to print the bare addresses and exclude the table
+//!
+//! @param map the bitmap
+//!
+void printI2C(const I2CMap_t map);
+
+//!
+//! @brief  scan I2C bus and print result
+//!
+//! @return number of devices on I2C bus
+//! @pre call Wire.begin before calling this function
+//!
+uint8_t scanI2C(void);
+
+//!
+//! @brief resumable scan of an I2C bus
+//! @details The scan is split into steps, which probe a limited number of addresses or spend a limited time.
+//!          Therefore a background scan can run in a periodic loop without causing overruns.
+//!          The bitmap of the last complete scan stays valid while the next scan is in progress.
+//!
+//!          @code
+//!          I2CScanner scanner;
+//!          I2CBusScanner<TwoWire> scanner1(Wire1);
+//!
+//!          void loop() {
+//!              // at most 4 probes or 300 us per period
+//!              if (scanner.step(4, 300))
+//!                  printI2C(scanner.getMap());
+//!              intervall.wait();
+//!          }
+//!          @endcode
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//!
+template <class Bus> class I2CBusScanner {
+
+  public:
+    //!
+    //! @brief Construct a new I2CBusScanner object for the full address range
+    //!
+    //! @param newBus the bus to scan
+    //!
+    I2CBusScanner(Bus& newBus = Wire) : bus(newBus) {
+        memset(result, 0, sizeof(result));
+
+        count     = 0;
+        valid     = false;
+        probeTime = 0;
+
+        begin();
+    }
+
+    //!
+    //! @brief start a new scan
+    //! @details a scan in progress is discarded
+    //!
+    //! @param newFirst first address to probe
+    //! @param newLast last address to probe
+    //!
+    void begin(uint8_t newFirst = I2C_FIRST_ADDRESS, uint8_t newLast = I2C_LAST_ADDRESS) {
+        first = newFirst < I2C_FIRST_ADDRESS ? I2C_FIRST_ADDRESS : newFirst;
+        last  = newLast > I2C_LAST_ADDRESS ? I2C_LAST_ADDRESS : newLast;
+
+        if (last < first)
+            last = first;
+
+        next          = first;
+        scanProbeTime = 0;
+
+        memset(current, 0, sizeof(current));
+    }
+
+    //!
+    //! @brief probe the next addresses
+    //! @details At least one address is probed per call. A further address is only probed if the longest
+    //!          probe of the last complete scan and of the scan in progress still fits into the time budget.
+    //!          After a complete scan the next call starts a new scan.
+    //! @pre call bus.begin before calling this function
+    //!
+    //! @param maxProbes maximum number of addresses to probe
+    //! @param maxMicros time budget in microseconds, 0 = no limit
+    //! @return true if this call has completed a scan
+    //!
+    bool step(uint8_t maxProbes, unsigned long maxMicros = 0) {
+        unsigned long start = RR_MICROS();
+
+        for (uint8_t probes = 0; probes < maxProbes || probes == 0; probes++) {
+            unsigned long before = RR_MICROS();
+
+            // does another probe fit into the budget?
+            if (probes > 0 && maxMicros > 0 && before - start + getProbeTime() > maxMicros)
+                break;
+
+            setI2CPresent(current, next, probeI2C(bus, next));
+
+            if (RR_MICROS() - before > scanProbeTime)
+                scanProbeTime = RR_MICROS() - before;
+
+            if (next++ >= last) {
+                // scan complete, publish the result and restart, a slow probe is forgotten after one scan
+                memcpy(result, current, sizeof(result));
+                count     = countI2C(result);
+                valid     = true;
+                probeTime = scanProbeTime;
+
+                begin(first, last);
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //!
+    //! @brief check if at least one scan has been completed
+    //!
+    //! @return true if getMap() contains a complete scan
+    //!
+    bool isValid(void) {
+        return valid;
+    }
+
+    //!
+    //! @brief return the bitmap of the last complete scan
+    //!
+    //! @return const uint8_t* the bitmap (I2CMap_t), empty if no scan has been completed
+    //!
+    const uint8_t* getMap(void) {
+        return result;
+    }
+
+    //!
+    //! @brief return the number of devices found by the last complete scan
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getCount(void) {
+        return count;
+    }
+
+    //!
+    //! @brief return the next address to probe
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getNextAddress(void) {
+        return next;
+    }
+
+    //!
+    //! @brief return the longest duration of a probe in the last complete scan and the scan in progress
+    //!
+    //! @return unsigned long microseconds
+    //!
+    unsigned long getProbeTime(void) {
+        return probeTime > scanProbeTime ? probeTime : scanProbeTime;
+    }
+
+  private:
+    Bus&          bus;       //!< the scanned bus
+    I2CMap_t      current;   //!< bitmap of the scan in progress
+    I2CMap_t      result;    //!< bitmap of the last complete scan
+    uint8_t       first;     //!< first address
+    uint8_t       last;      //!< last address
+    uint8_t       next;      //!< next address to probe
+    uint8_t       count;     //!< devices found by the last complete scan
+    bool          valid;     //!< at least one scan has been completed
+    unsigned long probeTime;     //!< longest duration of a probe in the last complete scan
+    unsigned long scanProbeTime; //!< longest duration of a probe in the scan in progress
+};
+
+//! @brief resumable scan of Wire
+typedef I2CBusScanner<TwoWire> I2CScanner;
+
+//!
+//! @brief cached inventory of the devices on an I2C bus with change detection
+//! @details After an initial full scan verify() only re-probes the known devices and a small rotating slice of
+//!          the unknown addresses. Added and removed devices are reported by a callback. A hot plugged device is
+//!          found after at most (112 - devices) / slice calls of verify().
+//!
+//! @tparam Bus type of the bus, e.g. TwoWire
+//!
+template <class Bus> class I2CBusInventory {
+
+  public:
+    //!
+    //! @brief called for every added or removed device
+    //!
+    //! @param address I2C address
+    //! @param present true if the device has been added, false if it has been removed
+    //! @param context context given in the constructor
+    //!
+    typedef void (*ChangeCallback_t)(uint8_t address, bool present, void* context);
+
+    //!
+    //! @brief Construct a new I2CBusInventory object for Wire
+    //!
+    //! @param onChange called for every change, may be NULL
+    //! @param context parameter of onChange
+    //!
+    I2CBusInventory(ChangeCallback_t onChange = NULL, void* context = NULL) : bus(Wire) {
+        init(onChange, context);
+    }
+
+    //!
+    //! @brief Construct a new I2CBusInventory object
+    //!
+    //! @param newBus the bus
+    //! @param onChange called for every change, may be NULL
+    //! @param context parameter of onChange
+    //!
+    I2CBusInventory(Bus& newBus, ChangeCallback_t onChange = NULL, void* context = NULL) : bus(newBus) {
+        init(onChange, context);
+    }
+
+    //!
+    //! @brief build the inventory with a full scan, no changes are reported
+    //! @pre call bus.begin before calling this function
+    //!
+    //! @return uint8_t number of devices
+    //!
+    uint8_t begin(void) {
+        count  = scanI2C(bus, map);
+        cursor = I2C_FIRST_ADDRESS;
+        probes = I2C_LAST_ADDRESS - I2C_FIRST_ADDRESS + 1;
+
+        return count;
+    }
+
+    //!
+    //! @brief re-probe the known devices and the next slice of unknown addresses
+    //!
+    //! @param slice number of unknown addresses to probe
+    //! @return uint8_t number of changes
+    //!
+    uint8_t verify(uint8_t slice = 4) {
+        uint8_t changes = 0;
+        uint8_t unknown = I2C_LAST_ADDRESS - I2C_FIRST_ADDRESS + 1 - count;
+
+        // known devices
+        for (uint8_t address = I2C_FIRST_ADDRESS; address <= I2C_LAST_ADDRESS; address++) {
+            if (isI2CPresent(map, address) && check(address))
+                changes++;
+        }
+
+        // the next slice of unknown addresses, which have not been added in this call
+        if (slice > unknown)
+            slice = unknown;
+
+        while (slice > 0) {
+            uint8_t address = cursor;
+
+            cursor = cursor < I2C_LAST_ADDRESS ? cursor + 1 : I2C_FIRST_ADDRESS;
+
+            if (!isI2CPresent(map, address)) {
+                if (check(address))
+                    changes++;
+                slice--;
+            }
+        }
+
+        return changes;
+    }
+
+    //!
+    //! @brief check if a device is in the inventory
+    //!
+    //! @param address I2C address
+    //! @return true if present
+    //!
+    bool isPresent(uint8_t address) {
+        return isI2CPresent(map, address);
+    }
+
+    //!
+    //! @brief return the bitmap of the inventory
+    //!
+    //! @return const uint8_t* the bitmap (I2CMap_t)
+    //!
+    const uint8_t* getMap(void) {
+        return map;
+    }
+
+    //!
+    //! @brief return the number of devices
+    //!
+    //! @return uint8_t
+    //!
+    uint8_t getCount(void) {
+        return count;
+    }
+
+    //!
+    //! @brief return the number of probes since begin()
+    //!
+    //! @return unsigned long
+    //!
+    unsigned long getProbes(void) {
+        return probes;
+    }
+
+  private:
+    //!
+    //! @brief initialize the members
+    //!
+    //! @param newOnChange called for every change
+    //! @param newContext parameter of onChange
+    //!
+    void init(ChangeCallback_t newOnChange, void* newContext) {
+        memset(map, 0, sizeof(map));
+
+        count    = 0;
+        cursor   = I2C_FIRST_ADDRESS;
+        probes   = 0;
+        onChange = newOnChange;
+        context  = newContext;
+    }
+
+    //!
+    //! @brief probe an address and report a change
+    //!
+    //! @param address I2C address
+    //! @return true if the state has changed
+    //!
+    bool check(uint8_t address) {
+        bool present = probeI2C(bus, address);
+
+        probes++;
+
+        if (present == isI2CPresent(map, address))
+            return false;
+
+        setI2CPresent(map, address, present);
+
+        if (present)
+            count++;
+        else
+            count--;
+
+        if (onChange)
+            onChange(address, present, context);
+
+        return true;
+    }
+
+    Bus&             bus;      //!< the bus
+    I2CMap_t         map;      //!< devices in the inventory
+    uint8_t          count;    //!< number of devices
+    uint8_t          cursor;   //!< next unknown address to probe
+    unsigned long    probes;   //!< number of probes since begin()
+    ChangeCallback_t onChange; //!< called for every change
+    void*            context;  //!< parameter of onChange
+};
+
+//! @brief cached inventory of Wire
+typedef I2CBusInventory<TwoWire> I2CInventory;
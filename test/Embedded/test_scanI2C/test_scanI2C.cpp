@@ -25,6 +25,52 @@ void test_noDevice(void) {
     TEST_ASSERT_EQUAL(scanI2C(), 0);
 }
 
+void test_bitmap(void) {
+    I2CMap_t      map;
+    unsigned long start = micros();
+
+    // the reserved addresses are skipped
+    TEST_ASSERT_EQUAL(0, scanI2C(map, 0, 127, 400000));
+    TEST_PRINTF("scan at 400 kHz: %lu us", micros() - start);
+
+    TEST_ASSERT_EQUAL(0, countI2C(map));
+}
+
+void test_stepwise(void) {
+    I2CScanner scanner;
+    unsigned   steps = 1;
+
+    TEST_ASSERT_FALSE(scanner.isValid());
+
+    // 112 addresses with 8 probes per step
+    while (!scanner.step(8))
+        steps++;
+
+    TEST_ASSERT_EQUAL(14, steps);
+    TEST_ASSERT_TRUE(scanner.isValid());
+    TEST_ASSERT_EQUAL(0, scanner.getCount());
+    TEST_ASSERT_EQUAL(I2C_FIRST_ADDRESS, scanner.getNextAddress());
+
+    // at least one probe, even if the budget is too small
+    scanner.step(255, 1);
+    TEST_ASSERT_GREATER_OR_EQUAL(I2C_FIRST_ADDRESS + 1, scanner.getNextAddress());
+    TEST_ASSERT_LESS_THAN(I2C_LAST_ADDRESS, scanner.getNextAddress());
+}
+
+void test_inventory(void) {
+    I2CInventory inventory;
+
+    TEST_ASSERT_EQUAL(0, inventory.begin());
+    TEST_ASSERT_EQUAL(112, inventory.getProbes());
+
+    // 4 unknown addresses per verification, all addresses are covered after 28 calls
+    for (uint8_t loop = 0; loop < 28; loop++)
+        TEST_ASSERT_EQUAL(0, inventory.verify(4));
+
+    TEST_ASSERT_EQUAL(112 + 28 * 4, inventory.getProbes());
+    TEST_ASSERT_EQUAL(0, inventory.getCount());
+}
+
 int runUnityTests(void) {
     Debug.setOutput(NULL);
     Wire.begin();
@@ -33,6 +79,9 @@ int runUnityTests(void) {
 
     // check all levels
     RUN_TEST(test_noDevice);
+    RUN_TEST(test_bitmap);
+    RUN_TEST(test_stepwise);
+    RUN_TEST(test_inventory);
 
     return UNITY_END();
 }
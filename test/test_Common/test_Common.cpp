@@ -31,10 +31,154 @@ void test_Macros(void) {
     TEST_ASSERT_EQUAL(0, ARRAY_SIZE(emptyArray));
 }
 
+void test_arraySize(void) {
+    int         intArray[]    = {1, 2, 3};
+    const char* stringArray[] = {"one", "two"};
+
+    static_assert(arraySize(intArray) == 3, "compile time constant");
+
+    TEST_ASSERT_EQUAL(2, arraySize(stringArray));
+
+    // a pointer does not compile:
+    // int* pointer = intArray;
+    // arraySize(pointer);
+}
+
+void test_RingBuffer(void) {
+    RingBuffer<int, 4> ring;
+    int                value;
+
+    TEST_ASSERT_TRUE(ring.isEmpty());
+    TEST_ASSERT_FALSE(ring.pop(value));
+
+    for (int loop = 1; loop <= 4; loop++)
+        TEST_ASSERT_TRUE(ring.push(loop));
+
+    TEST_ASSERT_TRUE(ring.isFull());
+    TEST_ASSERT_FALSE(ring.push(5));
+
+    // FIFO order
+    TEST_ASSERT_TRUE(ring.pop(value));
+    TEST_ASSERT_EQUAL(1, value);
+    TEST_ASSERT_EQUAL(3, ring.getCount());
+
+    // wrap around, the oldest element is dropped
+    ring.push(5);
+    ring.pushOverwrite(6);
+
+    TEST_ASSERT_EQUAL(4, ring.getCount());
+    TEST_ASSERT_EQUAL(3, ring[0]);
+    TEST_ASSERT_EQUAL(6, ring[3]);
+
+    ring.clear();
+    TEST_ASSERT_EQUAL(0, ring.getCount());
+    TEST_ASSERT_EQUAL(4, ring.getCapacity());
+}
+
+void test_StaticVector(void) {
+    StaticVector<uint8_t, 4> vector;
+    unsigned                 sum = 0;
+
+    TEST_ASSERT_NOT_NULL(vector.add(10));
+    TEST_ASSERT_NOT_NULL(vector.add(30));
+    TEST_ASSERT_TRUE(vector.insert(1, 20));
+    TEST_ASSERT_TRUE(vector.insert(0, 5));
+    TEST_ASSERT_NULL(vector.add(40));
+    TEST_ASSERT_FALSE(vector.insert(0, 1));
+
+    for (uint8_t value : vector)
+        sum += value;
+
+    TEST_ASSERT_EQUAL(65, sum);
+
+    TEST_ASSERT_TRUE(vector.remove(0));
+    TEST_ASSERT_FALSE(vector.remove(3));
+    TEST_ASSERT_EQUAL(3, vector.getCount());
+    TEST_ASSERT_EQUAL(10, vector[0]);
+    TEST_ASSERT_EQUAL(20, vector[1]);
+    TEST_ASSERT_EQUAL(30, vector[2]);
+}
+
+void test_BitSet(void) {
+    BitSet<100> bits;
+
+    TEST_ASSERT_EQUAL(13, sizeof(bits));
+
+    bits.set(0);
+    bits.set(42);
+    bits.set(99);
+    bits.set(100);
+
+    TEST_ASSERT_EQUAL(3, bits.count());
+    TEST_ASSERT_TRUE(bits.get(42));
+    TEST_ASSERT_FALSE(bits.get(43));
+    TEST_ASSERT_FALSE(bits.get(100));
+
+    TEST_ASSERT_EQUAL(0, bits.findNext());
+    TEST_ASSERT_EQUAL(42, bits.findNext(1));
+    TEST_ASSERT_EQUAL(99, bits.findNext(43));
+
+    bits.set(99, false);
+    TEST_ASSERT_EQUAL(100, bits.findNext(43));
+}
+
+void test_SortedMap(void) {
+    SortedMap<uint8_t, int, 4> map;
+
+    TEST_ASSERT_TRUE(map.set(0x68, 1));
+    TEST_ASSERT_TRUE(map.set(0x3C, 2));
+    TEST_ASSERT_TRUE(map.set(0x76, 3));
+    TEST_ASSERT_TRUE(map.set(0x20, 4));
+    TEST_ASSERT_FALSE(map.set(0x50, 5));
+
+    // replace
+    TEST_ASSERT_TRUE(map.set(0x3C, 20));
+    TEST_ASSERT_EQUAL(20, *map.find(0x3C));
+    TEST_ASSERT_NULL(map.find(0x50));
+
+    // ascending keys
+    TEST_ASSERT_EQUAL(0x20, map.getKey(0));
+    TEST_ASSERT_EQUAL(0x76, map.getKey(3));
+    TEST_ASSERT_EQUAL(3, map.getValue(3));
+
+    TEST_ASSERT_TRUE(map.remove(0x3C));
+    TEST_ASSERT_FALSE(map.remove(0x3C));
+    TEST_ASSERT_EQUAL(3, map.getCount());
+    TEST_ASSERT_EQUAL(0x68, map.getKey(1));
+}
+
+void test_I2CMap(void) {
+    I2CMap_t map = {0};
+
+    setI2CPresent(map, 0x08, true);
+    setI2CPresent(map, 0x3c, true);
+    setI2CPresent(map, 0x77, true);
+    setI2CPresent(map, 0x3c, true);
+    setI2CPresent(map, 200, true);
+
+    TEST_ASSERT_EQUAL(3, countI2C(map));
+    TEST_ASSERT_TRUE(isI2CPresent(map, 0x3c));
+    TEST_ASSERT_FALSE(isI2CPresent(map, 0x3d));
+    TEST_ASSERT_FALSE(isI2CPresent(map, 200));
+
+    setI2CPresent(map, 0x3c, false);
+
+    TEST_ASSERT_EQUAL(2, countI2C(map));
+    TEST_ASSERT_FALSE(isI2CPresent(map, 0x3c));
+    TEST_ASSERT_EQUAL_HEX8(0x01, map[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, map[14]);
+}
+
 int runUnityTests(void) {
     UNITY_BEGIN();
 
     RUN_TEST(test_Macros);
+    RUN_TEST(test_arraySize);
+    RUN_TEST(test_RingBuffer);
+    RUN_TEST(test_StaticVector);
+    RUN_TEST(test_BitSet);
+    RUN_TEST(test_SortedMap);
+    RUN_TEST(test_I2CMap);
 
     UNITY_END();
 
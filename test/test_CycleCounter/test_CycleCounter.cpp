@@ -0,0 +1,127 @@
+//!
+//! @file test_CycleCounter.cpp
+//! @author M. Nickels
+//! @brief unit test
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_Clock.h"
+#include "rr_StaticIntervall.h"
+
+//! code under test
+#include "rr_CycleCounter.h"
+
+//! @cond
+
+#ifdef RR_VIRTUAL_CLOCK
+    #define DELAY_US(us) VirtualClock::delayMicroseconds(us)
+#else
+    #define DELAY_US(us) delayMicroseconds(us)
+#endif
+
+void test_frequency(void) {
+    uint32_t frequency;
+
+    TEST_ASSERT_TRUE(CycleCounter::begin());
+
+    frequency = CycleCounter::getFrequency();
+    TEST_PRINTF("frequency: %lu Hz  overhead: %lu cycles", (unsigned long)frequency,
+                (unsigned long)CycleCounter::getOverhead());
+
+    // the calibration against micros() confirms the frequency
+    TEST_ASSERT_UINT_WITHIN(frequency / 50, frequency, CycleCounter::calibrate());
+}
+
+void test_measure(void) {
+    CycleCounter::Cycles_t start = CycleCounter::read();
+
+    DELAY_US(100);
+
+    CycleCounter::Cycles_t cycles = CycleCounter::elapsed(start);
+
+    TEST_ASSERT_UINT_WITHIN(10, 100, CycleCounter::toMicroseconds(cycles));
+    TEST_ASSERT_UINT_WITHIN(10000, 100000, CycleCounter::toNanoseconds(cycles));
+}
+
+#ifdef RR_VIRTUAL_CLOCK
+// the virtual counter runs at 1 GHz and wraps every 4.3 seconds
+void test_wrap(void) {
+    CycleCounter::Cycles_t start = CycleCounter::read();
+    bool                   wrapped = false;
+
+    for (unsigned loop = 0; loop < 10; loop++) {
+        CycleCounter::Cycles_t now;
+
+        VirtualClock::delay(1000);
+
+        now = CycleCounter::read();
+
+        if (now < start)
+            wrapped = true;
+
+        TEST_ASSERT_EQUAL(1000000000UL, now - start);
+        start = now;
+    }
+
+    TEST_ASSERT_TRUE(wrapped);
+}
+
+void test_staticIntervall(void) {
+    // 50 us period in cycles of the virtual counter
+    StaticIntervall<50000, IntervallNoStats, IntervallCycleClock> intervall;
+
+    intervall.begin();
+
+    DELAY_US(40);
+    TEST_ASSERT_FALSE(intervall.isPeriodOver());
+
+    DELAY_US(10);
+    TEST_ASSERT_TRUE(intervall.isPeriodOver());
+}
+#endif
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_frequency);
+    RUN_TEST(test_measure);
+#ifdef RR_VIRTUAL_CLOCK
+    RUN_TEST(test_wrap);
+    RUN_TEST(test_staticIntervall);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+// native environment
+int main() {
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
@@ -0,0 +1,167 @@
+//!
+//! @file test_CyclicExecutive.cpp
+//! @author M. Nickels
+//! @brief unit test
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_Clock.h"
+
+//! code under test
+#include "rr_CyclicExecutive.h"
+
+//! @cond
+
+unsigned      calls[5];
+unsigned long lastCall[5];
+unsigned      frameOrder;
+bool          ordered;
+
+// the tasks of a frame are called in the order of the task list
+template <unsigned Index> void task(void) {
+    if (frameOrder > Index)
+        ordered = false;
+
+    frameOrder = Index;
+    calls[Index]++;
+    lastCall[Index] = millis();
+}
+
+typedef CyclicExecutive<1, CyclicTask<task<0>, 1, 100>, CyclicTask<task<1>, 5, 100>, CyclicTask<task<2>, 10, 200>,
+                        CyclicTask<task<3>, 50, 200>, CyclicTask<task<4>, 100, 300> >
+    Executive;
+
+// the schedule is computed at compile time
+static_assert(Executive::getMajorFrame() == 100, "major frame");
+static_assert(Executive::getFrames() == 100, "frames");
+static_assert(Executive::getWorstCaseLoad() == 900, "worst case load");
+
+#ifndef ARDUINO_ARCH_AVR
+// a long major frame, the table does not fit into the flash of an UNO
+typedef CyclicExecutive<1, CyclicTask<task<0>, 1, 100>, CyclicTask<task<4>, 1000, 300> > LongExecutive;
+
+static_assert(LongExecutive::getFrames() == 1000, "frames");
+static_assert(LongExecutive::getWorstCaseLoad() == 400, "worst case load");
+#endif
+
+void resetCalls(void) {
+    for (unsigned loop = 0; loop < 5; loop++) {
+        calls[loop]    = 0;
+        lastCall[loop] = 0;
+    }
+
+    ordered = true;
+}
+
+void test_schedule(void) {
+    Executive executive;
+    unsigned  expected[] = {1000, 200, 100, 20, 10};
+
+    resetCalls();
+
+    for (unsigned frame = 0; frame < 1000; frame++) {
+        frameOrder = 0;
+        executive.dispatch();
+    }
+
+    for (unsigned loop = 0; loop < 5; loop++)
+        TEST_ASSERT_EQUAL(expected[loop], calls[loop]);
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL(0, executive.getFrame());
+}
+
+void test_run(void) {
+    Executive     executive;
+    Intervall     tick(1);
+    unsigned      periods[] = {1, 5, 10, 50, 100};
+    unsigned long previous[5];
+
+    resetCalls();
+    tick.begin();
+
+    for (unsigned frame = 0; frame < 500; frame++) {
+        for (unsigned loop = 0; loop < 5; loop++)
+            previous[loop] = lastCall[loop];
+
+        frameOrder = 0;
+        TEST_ASSERT_EQUAL(Intervall::Success, executive.run(tick));
+
+        // each task is released exactly with its period
+        for (unsigned loop = 0; loop < 5; loop++) {
+            if (previous[loop] != 0 && previous[loop] != lastCall[loop])
+                TEST_ASSERT_EQUAL(periods[loop], lastCall[loop] - previous[loop]);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(500, calls[0]);
+    TEST_ASSERT_EQUAL(5, calls[4]);
+}
+
+#ifndef ARDUINO_ARCH_AVR
+void test_long(void) {
+    LongExecutive executive;
+
+    resetCalls();
+
+    for (unsigned frame = 0; frame < 2000; frame++) {
+        frameOrder = 0;
+        executive.dispatch();
+    }
+
+    TEST_ASSERT_EQUAL(2000, calls[0]);
+    TEST_ASSERT_EQUAL(2, calls[4]);
+    TEST_ASSERT_TRUE(ordered);
+}
+#endif
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_schedule);
+    RUN_TEST(test_run);
+#ifndef ARDUINO_ARCH_AVR
+    RUN_TEST(test_long);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+using namespace fakeit;
+
+// native environment
+int main() {
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long t) -> void { VirtualClock::delay(t); });
+    When(Method(ArduinoFake(), millis)).AlwaysDo([](void) -> unsigned long { return VirtualClock::millis(); });
+    When(Method(ArduinoFake(), micros)).AlwaysDo([](void) -> unsigned long { return VirtualClock::micros(); });
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
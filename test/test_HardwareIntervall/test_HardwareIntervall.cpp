@@ -0,0 +1,186 @@
+//!
+//! @file test_HardwareIntervall.cpp
+//! @author M. Nickels
+//! @brief unit test
+//! @note Run tests with 'pio test -e test_native', the native environment simulates the timer on the virtual clock
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_Clock.h"
+
+//! code under test
+#include "rr_HardwareIntervall.h"
+
+//! @cond
+
+#if defined(RR_VIRTUAL_CLOCK)
+    #define REAL_MICROS()     VirtualClock::micros()
+    #define REAL_DELAY_MS(ms) VirtualClock::delay(ms)
+#elif defined(ARDUINO)
+    #define REAL_MICROS()     micros()
+    #define REAL_DELAY_MS(ms) delay(ms)
+#else
+    #include <chrono>
+    #include <thread>
+
+    #define REAL_MICROS()                                                                                              \
+        ((unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(                                         \
+             std::chrono::steady_clock::now().time_since_epoch())                                                      \
+             .count())
+    #define REAL_DELAY_MS(ms) std::this_thread::sleep_for(std::chrono::milliseconds(ms))
+#endif
+
+const HardwareIntervall::Period_t period = 2000;
+const unsigned                    loops  = 200;
+
+void test_wait(void) {
+    HardwareIntervall intervall(period);
+    unsigned long     start;
+    unsigned long     elapsed;
+    unsigned          success = 0;
+
+    TEST_ASSERT_TRUE(intervall.begin());
+    start = REAL_MICROS();
+
+    for (unsigned loop = 0; loop < loops; loop++) {
+        if (intervall.wait() == Intervall::Success)
+            success++;
+    }
+
+    elapsed = REAL_MICROS() - start;
+    intervall.end();
+
+#ifdef RR_VIRTUAL_CLOCK
+    // the simulated timer runs on the virtual clock, each wait() returns at the end of a period
+    TEST_ASSERT_EQUAL(loops * period, elapsed);
+    TEST_ASSERT_EQUAL(loops, success);
+#else
+    // the periods do not drift, a loaded test machine may miss some interrupts
+    TEST_ASSERT_UINT_WITHIN(loops * period / 20, loops * period, elapsed);
+    TEST_ASSERT_GREATER_OR_EQUAL(loops * 9 / 10, success);
+#endif
+
+#ifndef WITHOUT_INTERVALL_STATS
+    intervall.printStatistics();
+    TEST_ASSERT_LESS_THAN(period, intervall.getAvgPeriod());
+#endif
+}
+
+void test_missed(void) {
+    HardwareIntervall intervall(period);
+
+    TEST_ASSERT_TRUE(intervall.begin());
+    TEST_ASSERT_FALSE(intervall.isPeriodOver());
+
+    // busy for five periods
+    REAL_DELAY_MS(5 * period / 1000 + 1);
+
+    TEST_ASSERT_TRUE(intervall.isPeriodOver());
+#ifdef RR_VIRTUAL_CLOCK
+    TEST_ASSERT_EQUAL(4, intervall.getMissed());
+    TEST_ASSERT_FALSE(intervall.isPeriodOver());
+#else
+    TEST_ASSERT_GREATER_OR_EQUAL(4, intervall.getMissed());
+#endif
+
+#ifdef WITH_INTERVALL_TRACE
+    Intervall::TraceEvent_t event;
+
+    Intervall::clearTrace();
+#endif
+
+    // busy longer than a period
+    REAL_DELAY_MS(2 * period / 1000 + 1);
+    TEST_ASSERT_EQUAL(Intervall::Overflow, intervall.wait());
+
+#ifdef WITH_INTERVALL_TRACE
+    // the overflow is recorded in microseconds
+    TEST_ASSERT_EQUAL(1, Intervall::getTraceCount());
+    TEST_ASSERT_TRUE(Intervall::getTraceEvent(0, event));
+    TEST_ASSERT_EQUAL(period, event.period);
+    TEST_ASSERT_GREATER_OR_EQUAL(period, event.duration);
+#endif
+
+    intervall.end();
+}
+
+volatile unsigned callbacks = 0;
+
+void countCallback(void* context) {
+    callbacks += *(unsigned*)context;
+}
+
+bool abortWait(void) {
+    return true;
+}
+
+void test_callback(void) {
+    HardwareIntervall intervall(period);
+    unsigned          increment = 1;
+
+    callbacks = 0;
+    intervall.setCallback(countCallback, &increment);
+
+    TEST_ASSERT_TRUE(intervall.begin());
+
+    for (unsigned loop = 0; loop < 10; loop++)
+        intervall.wait();
+
+    intervall.end();
+
+#ifdef RR_VIRTUAL_CLOCK
+    TEST_ASSERT_EQUAL(10, callbacks);
+#else
+    TEST_ASSERT_GREATER_OR_EQUAL(10, callbacks);
+    TEST_ASSERT_LESS_OR_EQUAL(11, callbacks);
+#endif
+
+    // aborted and stopped intervalls
+    TEST_ASSERT_TRUE(intervall.begin());
+    TEST_ASSERT_EQUAL(Intervall::Abort, intervall.wait(abortWait));
+
+    intervall.end();
+    TEST_ASSERT_EQUAL(Intervall::Failure, intervall.wait());
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_wait);
+    RUN_TEST(test_missed);
+    RUN_TEST(test_callback);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+// native environment
+int main() {
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
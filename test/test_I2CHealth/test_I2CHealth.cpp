@@ -0,0 +1,165 @@
+//!
+//! @file test_I2CHealth.cpp
+//! @author M. Nickels
+//! @brief unit test with a simulated I2C bus
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_MockI2CBus.h"
+#include "rr_scanI2C.h"
+
+//! code under test
+#include "rr_I2CHealth.h"
+
+//! @cond
+
+#define TEST_SDA 4
+#define TEST_SCL 5
+
+typedef I2CHealthBus<MockI2CBus, 4> HealthBus_t;
+
+void test_counters(void) {
+    MockI2CBus  mock;
+    HealthBus_t bus(mock, TEST_SDA, TEST_SCL, 0);
+    I2CMap_t    map;
+
+    mock.addDevice(0x3C);
+    mock.addDevice(0x68);
+    mock.setFault(0x50, 4);
+    mock.setFault(0x51, 5);
+
+    TEST_ASSERT_EQUAL(2, scanI2C(bus, map));
+
+    // bus
+    TEST_ASSERT_EQUAL(2, bus.getCount(HealthBus_t::Ack));
+    TEST_ASSERT_EQUAL(108, bus.getCount(HealthBus_t::Nak));
+    TEST_ASSERT_EQUAL(1, bus.getCount(HealthBus_t::Timeout));
+    TEST_ASSERT_EQUAL(1, bus.getCount(HealthBus_t::Error));
+    TEST_ASSERT_EQUAL(0, bus.getRecoveries());
+
+    // 9 bits at 100 kHz
+    TEST_ASSERT_EQUAL(112, bus.getLatency().getCount());
+    TEST_ASSERT_EQUAL(90, bus.getLatency().getMin());
+    TEST_ASSERT_EQUAL(90, bus.getLatency().getMax());
+
+    // addresses
+    TEST_ASSERT_EQUAL(1, bus.getCount(0x3C, HealthBus_t::Ack));
+    TEST_ASSERT_EQUAL(1, bus.getCount(0x50, HealthBus_t::Error));
+    TEST_ASSERT_EQUAL(1, bus.getCount(0x51, HealthBus_t::Timeout));
+    TEST_ASSERT_EQUAL(90, bus.getMaxLatency(0x68));
+
+    // plain NAKs have no entry
+    TEST_ASSERT_EQUAL(0, bus.getCount(0x20, HealthBus_t::Nak));
+
+    // a NAK of a known device is counted
+    mock.removeDevice(0x3C);
+    TEST_ASSERT_FALSE(probeI2C(bus, 0x3C));
+    TEST_ASSERT_EQUAL(1, bus.getCount(0x3C, HealthBus_t::Nak));
+
+    bus.printStatistics();
+    bus.resetStatistics();
+    TEST_ASSERT_EQUAL(0, bus.getCount(HealthBus_t::Ack));
+    TEST_ASSERT_EQUAL(0, bus.getCount(0x68, HealthBus_t::Ack));
+}
+
+bool releaseMock(void* context) {
+    ((MockI2CBus*)context)->setStuck(false);
+
+    return true;
+}
+
+void test_recovery(void) {
+    MockI2CBus    mock;
+    HealthBus_t   bus(mock, TEST_SDA, TEST_SCL);
+    unsigned long start;
+
+    mock.addDevice(0x3C);
+    bus.setRecovery(releaseMock, &mock);
+    bus.setClock(400000);
+
+    TEST_ASSERT_TRUE(probeI2C(bus, 0x3C));
+
+    // the third failure in a row triggers the recovery
+    mock.setStuck(true);
+    start = VirtualClock::micros();
+
+    TEST_ASSERT_FALSE(probeI2C(bus, 0x3C));
+    TEST_ASSERT_FALSE(probeI2C(bus, 0x3C));
+    TEST_ASSERT_TRUE(mock.isStuck());
+    TEST_ASSERT_FALSE(probeI2C(bus, 0x3C));
+    TEST_ASSERT_FALSE(mock.isStuck());
+
+    TEST_PRINTF("bus recovered after %lu us", VirtualClock::micros() - start);
+    TEST_ASSERT_EQUAL(1, bus.getRecoveries());
+    TEST_ASSERT_TRUE(probeI2C(bus, 0x3C));
+
+    // failures, which are interrupted by a success, do not trigger
+    mock.setFault(0x50, 4);
+    mock.addDevice(0x50);
+
+    for (uint8_t loop = 0; loop < 10; loop++) {
+        probeI2C(bus, 0x50);
+        probeI2C(bus, 0x3C);
+    }
+
+    TEST_ASSERT_EQUAL(1, bus.getRecoveries());
+    TEST_ASSERT_EQUAL(10, bus.getCount(0x50, HealthBus_t::Error));
+}
+
+void test_recoverI2C(void) {
+    // the lines are released by the pull ups
+    TEST_ASSERT_TRUE(recoverI2C(TEST_SDA, TEST_SCL));
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_counters);
+    RUN_TEST(test_recovery);
+    RUN_TEST(test_recoverI2C);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+using namespace fakeit;
+
+// native environment
+int main() {
+    When(Method(ArduinoFake(), micros)).AlwaysDo([](void) -> unsigned long { return VirtualClock::micros(); });
+    When(Method(ArduinoFake(), delayMicroseconds)).AlwaysDo([](unsigned int us) {
+        VirtualClock::delayMicroseconds(us);
+    });
+    When(Method(ArduinoFake(), pinMode)).AlwaysReturn();
+    When(Method(ArduinoFake(), digitalWrite)).AlwaysReturn();
+    When(Method(ArduinoFake(), digitalRead)).AlwaysReturn(HIGH);
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
@@ -0,0 +1,217 @@
+//!
+//! @file test_I2CRegisters.cpp
+//! @author M. Nickels
+//! @brief unit test and benchmark with a simulated I2C bus
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_MockI2CBus.h"
+
+//! code under test
+#include "rr_I2CRegisters.h"
+
+//! @cond
+
+#define IMU 0x68
+
+MockI2CBus bus;
+
+// an IMU with 14 registers of measurements from 0x3B
+void resetBus(void) {
+    bus = MockI2CBus();
+
+    bus.addDevice(IMU);
+
+    for (uint8_t reg = 0x3B; reg < 0x3B + 14; reg++)
+        bus.setRegister(IMU, reg, reg);
+}
+
+void test_burst(void) {
+    I2CBusDevice<MockI2CBus> imu(bus, IMU);
+    uint8_t                  raw[14];
+    uint8_t                  block[40];
+    uint8_t                  value;
+
+    resetBus();
+
+    // one write of the register address and one read
+    TEST_ASSERT_TRUE(imu.readRegisters(0x3B, raw, sizeof(raw)));
+    TEST_ASSERT_EQUAL(2, bus.getTransactions());
+
+    for (uint8_t index = 0; index < sizeof(raw); index++)
+        TEST_ASSERT_EQUAL(0x3B + index, raw[index]);
+
+    // single registers
+    TEST_ASSERT_TRUE(imu.writeRegister(0x6B, 0x80));
+    TEST_ASSERT_EQUAL_HEX8(0x80, bus.getRegister(IMU, 0x6B));
+    TEST_ASSERT_TRUE(imu.readRegister(0x3C, value));
+    TEST_ASSERT_EQUAL_HEX8(0x3C, value);
+
+    // bursts, which exceed the buffer, are split
+    for (uint8_t index = 0; index < sizeof(block); index++)
+        block[index] = 0x80 + index;
+
+    bus.resetStatistics();
+    TEST_ASSERT_TRUE(imu.writeRegisters(0x80, block, sizeof(block)));
+    TEST_ASSERT_EQUAL(2, bus.getTransactions());
+    TEST_ASSERT_EQUAL_HEX8(0x80 + 39, bus.getRegister(IMU, 0x80 + 39));
+
+    memset(block, 0, sizeof(block));
+    bus.resetStatistics();
+    TEST_ASSERT_TRUE(imu.readRegisters(0x80, block, sizeof(block)));
+    TEST_ASSERT_EQUAL(4, bus.getTransactions());
+
+    for (uint8_t index = 0; index < sizeof(block); index++)
+        TEST_ASSERT_EQUAL(0x80 + index, block[index]);
+
+    // missing device
+    TEST_ASSERT_FALSE(readI2CRegisters(bus, 0x69, 0x3B, raw, sizeof(raw)));
+    TEST_ASSERT_FALSE(writeI2CRegister(bus, 0x69, 0x6B, 0x00));
+}
+
+struct Completed {
+    uint8_t done;
+    uint8_t failed;
+};
+
+void onComplete(I2CTransaction& transaction, void* context) {
+    Completed* completed = (Completed*)context;
+
+    if (transaction.status == I2CTransaction::Done)
+        completed->done++;
+    else
+        completed->failed++;
+}
+
+void test_queue(void) {
+    I2CBusQueue<MockI2CBus, 3> queue(bus);
+    Completed                  completed = {0, 0};
+    uint8_t                    raw[14];
+    uint8_t                    config[2] = {0x01, 0x02};
+    I2CTransaction             read      = {IMU, 0x3B, raw, sizeof(raw), false, I2CTransaction::Idle};
+    I2CTransaction             write     = {IMU, 0x1A, config, sizeof(config), true, I2CTransaction::Idle};
+    I2CTransaction             missing   = {0x69, 0x3B, raw, sizeof(raw), false, I2CTransaction::Idle};
+
+    resetBus();
+    queue.setCallback(onComplete, &completed);
+
+    TEST_ASSERT_TRUE(queue.add(write));
+    TEST_ASSERT_TRUE(queue.add(missing));
+    TEST_ASSERT_TRUE(queue.add(read));
+    TEST_ASSERT_FALSE(queue.add(read));
+    TEST_ASSERT_EQUAL(I2CTransaction::Pending, read.status);
+
+    TEST_ASSERT_EQUAL(1, queue.run());
+    TEST_ASSERT_EQUAL(0, queue.getCount());
+
+    TEST_ASSERT_EQUAL(I2CTransaction::Done, write.status);
+    TEST_ASSERT_EQUAL(I2CTransaction::Failed, missing.status);
+    TEST_ASSERT_EQUAL(I2CTransaction::Done, read.status);
+    TEST_ASSERT_EQUAL(2, completed.done);
+    TEST_ASSERT_EQUAL(1, completed.failed);
+
+    TEST_ASSERT_EQUAL_HEX8(0x02, bus.getRegister(IMU, 0x1B));
+    TEST_ASSERT_EQUAL(0x3B + 13, raw[13]);
+}
+
+void test_step(void) {
+    I2CBusQueue<MockI2CBus, 4> queue(bus);
+    uint8_t                    raw[4][14];
+    I2CTransaction             reads[4];
+    unsigned                   steps = 1;
+
+    resetBus();
+
+    for (uint8_t index = 0; index < 4; index++) {
+        reads[index] = {IMU, 0x3B, raw[index], sizeof(raw[index]), false, I2CTransaction::Idle};
+        queue.add(reads[index]);
+    }
+
+    // 2 + 15 bytes = 1530 us at 100 kHz, one transaction per step
+    TEST_ASSERT_FALSE(queue.step(2000));
+    TEST_ASSERT_EQUAL(1530, queue.getMaxTime());
+    TEST_ASSERT_EQUAL(3, queue.getCount());
+    TEST_ASSERT_EQUAL(I2CTransaction::Done, reads[0].status);
+    TEST_ASSERT_EQUAL(I2CTransaction::Pending, reads[1].status);
+
+    // two transactions per step
+    while (!queue.step(3500))
+        steps++;
+
+    TEST_ASSERT_EQUAL(2, steps);
+    TEST_ASSERT_EQUAL(I2CTransaction::Done, reads[3].status);
+}
+
+// simulated bus time of a register by register read compared with a burst
+void test_benchmark(void) {
+    I2CBusDevice<MockI2CBus> imu(bus, IMU);
+    uint8_t                  raw[14];
+    unsigned long            naive;
+    unsigned long            burst;
+
+    resetBus();
+    bus.setClock(400000);
+    bus.setLatency(20);
+
+    for (uint8_t index = 0; index < sizeof(raw); index++)
+        imu.readRegister(0x3B + index, raw[index]);
+
+    naive = bus.getBusyTime();
+
+    bus.resetStatistics();
+    imu.readRegisters(0x3B, raw, sizeof(raw));
+
+    burst = bus.getBusyTime();
+
+    TEST_PRINTF("14 registers at 400 kHz: single %lu us, burst %lu us, %lu bytes/s", naive, burst,
+                14 * 1000000UL / burst);
+    TEST_ASSERT_LESS_THAN(naive / 3, burst);
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_burst);
+    RUN_TEST(test_queue);
+    RUN_TEST(test_step);
+    RUN_TEST(test_benchmark);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+using namespace fakeit;
+
+// native environment
+int main() {
+    When(Method(ArduinoFake(), micros)).AlwaysDo([](void) -> unsigned long { return VirtualClock::micros(); });
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
@@ -15,6 +15,7 @@
 #include <Arduino.h>
 #include <unity.h>
 
+#include "rr_Clock.h"
 #include "rr_DebugUtils.h"
 #include "rr_Intervall.h"
 
@@ -22,13 +23,20 @@
 
 const unsigned long period = 500; // 500 milliss
 
+#ifdef RR_VIRTUAL_CLOCK
+// virtual time costs nothing
+const unsigned iterations = 1000;
+#else
+const unsigned iterations = 10;
+#endif
+
 // test a normal intervall
 void test_normal(void) {
     Intervall intervall(period);
 
     intervall.begin();
 
-    for (unsigned loop = 0; loop < 10; loop++) {
+    for (unsigned loop = 0; loop < iterations; loop++) {
         unsigned long start = millis();
 
         // t = 0
@@ -59,7 +67,7 @@ void test_random(void) {
 
     intervall.begin();
 
-    for (unsigned loop = 0; loop < 10; loop++) {
+    for (unsigned loop = 0; loop < iterations; loop++) {
         // waste some random time
         delay(random(period - 15, period - 4));
 
@@ -73,6 +81,124 @@ void test_random(void) {
     TEST_ASSERT_UINT_WITHIN(6, period - 10, intervall.getAvgPeriod());
 }
 
+// test the load meter
+void test_load(void) {
+    Intervall intervall(period);
+
+    intervall.setLoadWindow(5);
+    intervall.begin();
+
+    // one busy period
+    delay(period - 50);
+    intervall.wait();
+
+    // followed by lighter periods
+    for (unsigned loop = 0; loop < 3; loop++) {
+        delay(period / 2);
+        intervall.wait();
+    }
+
+    intervall.printStatistics();
+
+    TEST_ASSERT_UINT_WITHIN(4, 500, intervall.getLoad());
+    TEST_ASSERT_UINT_WITHIN(4, 900, intervall.getPeakLoad());
+    TEST_ASSERT_UINT_WITHIN(2, 50, intervall.getHeadroom());
+    TEST_ASSERT_TRUE(intervall.getAvgLoad() > 500 && intervall.getAvgLoad() < 900);
+
+    // after two windows the busy period has been forgotten
+    for (unsigned loop = 0; loop < 10; loop++) {
+        delay(period / 2);
+        intervall.wait();
+    }
+
+    TEST_ASSERT_UINT_WITHIN(4, 500, intervall.getPeakLoad());
+
+    // a period of 0 has no load
+    Intervall zero(0);
+
+    zero.begin();
+    delay(10);
+    zero.wait();
+
+    TEST_ASSERT_EQUAL(0, zero.getLoad());
+    TEST_ASSERT_EQUAL(0, zero.getAvgLoad());
+    TEST_ASSERT_EQUAL(0, zero.getPeakLoad());
+    TEST_ASSERT_EQUAL(0, zero.getHeadroom());
+}
+
+#ifdef WITH_INTERVALL_ADAPTIVE
+// test the adaptive period under a step load
+unsigned periodCallbacks = 0;
+
+void onPeriodChange(Intervall::Period_t) {
+    periodCallbacks++;
+}
+
+// run periods with a constant busy time, return the number of overflows and period changes in the second half
+void runLoad(Intervall& intervall, unsigned long busy, unsigned count, unsigned& overflows, unsigned& changes) {
+    overflows = 0;
+    changes   = 0;
+
+    for (unsigned loop = 0; loop < count; loop++) {
+        unsigned before = intervall.getPeriodChanges();
+
+        delay(busy);
+
+        if (intervall.wait() == Intervall::Overflow)
+            overflows++;
+
+        if (loop >= count / 2)
+            changes += intervall.getPeriodChanges() - before;
+    }
+}
+
+void test_adaptive(void) {
+    Intervall intervall(100), slow(1000);
+    unsigned  overflows, changes;
+
+    // the period is clamped into the adaptive range
+    slow.setAdaptive(50, 400);
+    TEST_ASSERT_EQUAL(400, slow.getPeriod());
+
+    periodCallbacks = 0;
+    intervall.setAdaptive(50, 400, onPeriodChange);
+    intervall.begin();
+
+    // light load, the period shrinks until the load is within the hysteresis
+    runLoad(intervall, 40, 200, overflows, changes);
+
+    TEST_ASSERT_EQUAL(0, overflows);
+    TEST_ASSERT_EQUAL(0, changes);
+    TEST_ASSERT_LESS_THAN(100, intervall.getPeriod());
+    TEST_ASSERT_GREATER_OR_EQUAL(INTERVALL_ADAPT_LOW, intervall.getAvgLoad());
+    TEST_ASSERT_LESS_OR_EQUAL(INTERVALL_ADAPT_HIGH, intervall.getAvgLoad());
+
+    // step to heavy load, the period is stretched after a few overflows
+    runLoad(intervall, 150, 200, overflows, changes);
+
+    TEST_ASSERT_LESS_OR_EQUAL(20, overflows);
+    TEST_ASSERT_EQUAL(0, changes);
+    TEST_ASSERT_GREATER_THAN(150, intervall.getPeriod());
+    TEST_ASSERT_LESS_OR_EQUAL(INTERVALL_ADAPT_HIGH, intervall.getAvgLoad());
+
+    // load above the maximum period
+    runLoad(intervall, 450, 50, overflows, changes);
+
+    TEST_ASSERT_EQUAL(400, intervall.getPeriod());
+
+    // back to light load, the period shrinks again
+    runLoad(intervall, 40, 600, overflows, changes);
+
+    TEST_ASSERT_EQUAL(0, overflows);
+    TEST_ASSERT_EQUAL(0, changes);
+    TEST_ASSERT_LESS_THAN(100, intervall.getPeriod());
+    TEST_ASSERT_GREATER_OR_EQUAL(INTERVALL_ADAPT_LOW, intervall.getAvgLoad());
+
+    TEST_ASSERT_EQUAL(intervall.getPeriodChanges(), periodCallbacks);
+    TEST_PRINTF("period changes: %u", intervall.getPeriodChanges());
+}
+#endif
+
 // test an aborted intervall
 bool abort_function(void) {
     return true;
@@ -83,7 +209,7 @@ void test_abort(void) {
 
     intervall.begin();
 
-    for (unsigned loop = 0; loop < 10; loop++) {
+    for (unsigned loop = 0; loop < iterations; loop++) {
         // waste some time
         delay(period - 10);
 
@@ -93,13 +219,170 @@ void test_abort(void) {
     intervall.printStatistics();
 }
 
+// test an aborted intervall with context
+bool abort_context_function(void* context) {
+    unsigned* calls = (unsigned*)context;
+
+    return ++(*calls) >= 5;
+}
+
+void test_abort_context(void) {
+    Intervall intervall(period);
+    unsigned  calls = 0;
+
+    intervall.begin();
+
+    TEST_ASSERT_EQUAL(Intervall::Abort, intervall.wait(abort_context_function, &calls));
+    TEST_ASSERT_EQUAL(5, calls);
+}
+
+// test a wait with a functor
+struct CountingFunctor {
+    unsigned calls;
+
+    bool operator()(void) {
+        calls++;
+        return false;
+    }
+};
+
+void test_functor(void) {
+    Intervall       intervall(period);
+    CountingFunctor functor = {0};
+
+    intervall.begin();
+
+    delay(period - 10);
+
+    TEST_ASSERT_EQUAL(Intervall::Success, intervall.waitFor(functor));
+    TEST_ASSERT_GREATER_THAN(0, functor.calls);
+
+    // a temporary lambda
+    functor.calls = 0;
+    delay(period - 10);
+
+    TEST_ASSERT_EQUAL(Intervall::Success, intervall.waitFor([&functor]() { return functor(); }));
+    TEST_ASSERT_GREATER_THAN(0, functor.calls);
+}
+
+// test non blocking poll()
+void test_poll(void) {
+    Intervall     intervall(period);
+    unsigned long start;
+    unsigned      due = 0;
+
+    intervall.begin();
+    start = millis();
+
+    for (unsigned loop = 0; loop < iterations; loop++) {
+        // waste some time, but less than a period
+        delay(period / 10);
+
+        switch (intervall.poll()) {
+        case Intervall::Due:
+            due++;
+            break;
+        case Intervall::Overrun:
+            TEST_FAIL();
+            break;
+        default:
+            break;
+        }
+    }
+
+    // there is no drift, every 10th poll is due
+    TEST_ASSERT_UINT_WITHIN(1, (millis() - start) / period, due);
+
+    // miss two periods
+    delay(2 * period + 10);
+
+    TEST_ASSERT_EQUAL(Intervall::Overrun, intervall.poll());
+    TEST_ASSERT_EQUAL(Intervall::NotDue, intervall.poll());
+
+    // the busy time statistics are only recorded by wait()
+    TEST_ASSERT_EQUAL(0, intervall.getMaxPeriod());
+    TEST_ASSERT_EQUAL(1, intervall.getOverruns());
+}
+
+// count the milliseconds, in which more than one intervall of the group is due
+unsigned countCollisions(Intervall* group[], uint8_t count) {
+    unsigned collisions = 0;
+
+    for (unsigned tick = 0; tick < 1000; tick++) {
+        uint8_t due = 0;
+
+        delay(1);
+
+        for (uint8_t index = 0; index < count; index++) {
+            if (group[index]->poll() != Intervall::NotDue)
+                due++;
+        }
+
+        if (due > 1)
+            collisions++;
+    }
+
+    return collisions;
+}
+
+// test phase offsets and staggering
+void test_phase(void) {
+    Intervall     fast(10), medium(20), slow(50);
+    Intervall*    group[] = {&fast, &medium, &slow};
+    unsigned long start;
+
+    // explicit offset: the first period is shortened, all further periods are complete
+    fast.setPhase(13);
+    TEST_ASSERT_EQUAL(13, fast.getPhase());
+
+    fast.begin();
+    start = millis();
+
+    while (fast.poll() == Intervall::NotDue)
+        delay(1);
+    TEST_ASSERT_UINT_WITHIN(1, 3, millis() - start);
+
+    while (fast.poll() == Intervall::NotDue)
+        delay(1);
+    TEST_ASSERT_UINT_WITHIN(1, 13, millis() - start);
+
+#ifdef RR_VIRTUAL_CLOCK
+    // a start, which is moved to 0, must not look like an intervall without begin()
+    VirtualClock::set(7);
+    fast.begin();
+    TEST_ASSERT_FALSE(fast.isPeriodOver());
+
+    fast.setPhase(0);
+    VirtualClock::set(0);
+    fast.begin();
+    TEST_ASSERT_FALSE(fast.isPeriodOver());
+#endif
+
+    // without offsets all intervalls end together
+    for (uint8_t index = 0; index < 3; index++) {
+        group[index]->setPhase(0);
+        group[index]->begin();
+    }
+
+    // every 20 ms and additionally at 50, 150, 250 ... ms
+    TEST_ASSERT_EQUAL(1000 / 20 + 1000 / 100, countCollisions(group, 3));
+
+    // staggered across the common divisor of 10 ms
+    Intervall::stagger(group, 3);
+
+    TEST_ASSERT_EQUAL(0, fast.getPhase());
+    TEST_ASSERT_EQUAL(3, medium.getPhase());
+    TEST_ASSERT_EQUAL(6, slow.getPhase());
+    TEST_ASSERT_EQUAL(0, countCollisions(group, 3));
+}
+
 // test overflowed intervall
 void test_overflow(void) {
     Intervall intervall(period);
 
     intervall.begin();
 
-    for (unsigned loop = 0; loop < 10; loop++) {
+    for (unsigned loop = 0; loop < iterations; loop++) {
         // waste more time than expected
         delay(period + 10);
 
@@ -113,6 +396,112 @@ void test_overflow(void) {
     TEST_ASSERT_UINT_WITHIN(1, period + 10, intervall.getAvgPeriod());
 }
 
+#ifdef WITH_INTERVALL_TRACE
+// test the overrun trace
+void test_trace(void) {
+    Intervall               first(period), second(period);
+    Intervall::TraceEvent_t event;
+
+    Intervall::clearTrace();
+    first.setId(1);
+    second.setId(2);
+
+    first.begin();
+    second.begin();
+
+    // overflow only the first intervall
+    delay(period + 10);
+
+    TEST_ASSERT_EQUAL(Intervall::Overflow, first.wait());
+
+    second.begin();
+
+    // overflow the second intervall with a larger duration
+    delay(period + 20);
+
+    TEST_ASSERT_EQUAL(Intervall::Overflow, second.wait());
+
+    Intervall::printTrace();
+
+    TEST_ASSERT_EQUAL(2, Intervall::getTraceCount());
+
+    // latest event first
+    TEST_ASSERT_TRUE(Intervall::getTraceEvent(0, event));
+    TEST_ASSERT_EQUAL(2, event.id);
+    TEST_ASSERT_EQUAL(period, event.period);
+    TEST_ASSERT_UINT_WITHIN(1, period + 20, event.duration);
+
+    TEST_ASSERT_TRUE(Intervall::getTraceEvent(1, event));
+    TEST_ASSERT_EQUAL(1, event.id);
+    TEST_ASSERT_UINT_WITHIN(1, period + 10, event.duration);
+
+    TEST_ASSERT_FALSE(Intervall::getTraceEvent(2, event));
+
+    // the ring keeps the latest events only
+    for (unsigned loop = 0; loop < 2 * INTERVALL_TRACE_SIZE; loop++) {
+        delay(period + 10);
+        second.wait();
+    }
+
+    TEST_ASSERT_EQUAL(INTERVALL_TRACE_SIZE, Intervall::getTraceCount());
+    TEST_ASSERT_TRUE(Intervall::getTraceEvent(INTERVALL_TRACE_SIZE - 1, event));
+    TEST_ASSERT_EQUAL(2, event.id);
+}
+#endif
+
+#ifdef WITH_INTERVALL_REGISTRY
+// test registered intervalls and the report
+void test_registry(void) {
+    Intervall  fast(period), slow(2 * period);
+    Intervall* intervall;
+    unsigned   count = 0;
+
+    TEST_ASSERT_NULL(Intervall::getFirst());
+
+    fast.registerAs(F("fast"));
+    slow.registerAs(F("slow"));
+    slow.registerAs(F("slow"));
+
+    {
+        Intervall temporary(period);
+
+        temporary.registerAs(NULL);
+        TEST_ASSERT_EQUAL_PTR(&temporary, Intervall::getFirst());
+    }
+
+    // the destructor removes the temporary intervall
+    for (intervall = Intervall::getFirst(); intervall != NULL; intervall = intervall->getNext())
+        count++;
+
+    TEST_ASSERT_EQUAL(2, count);
+    TEST_ASSERT_EQUAL_PTR(&slow, Intervall::getFirst());
+    TEST_ASSERT_EQUAL_STRING("fast", (const char*)slow.getNext()->getName());
+
+    fast.begin();
+    slow.begin();
+
+    delay(period + 10);
+    TEST_ASSERT_EQUAL(Intervall::Overflow, fast.wait());
+    TEST_ASSERT_EQUAL(Intervall::Success, slow.wait());
+
+    TEST_ASSERT_EQUAL(1, fast.getOverruns());
+    TEST_ASSERT_EQUAL(0, slow.getOverruns());
+
+    Intervall::printReport();
+    Intervall::resetAllStatistics();
+
+    TEST_ASSERT_EQUAL(0, fast.getOverruns());
+    TEST_ASSERT_EQUAL(0, slow.getPeakLoad());
+
+    fast.unregister();
+    TEST_ASSERT_EQUAL_PTR(&slow, Intervall::getFirst());
+    TEST_ASSERT_NULL(slow.getNext());
+
+    slow.unregister();
+    TEST_ASSERT_NULL(Intervall::getFirst());
+}
+#endif
+
 // test failure without begin() before wait()
 void test_no_begin(void) {
     Intervall intervall(period);
@@ -141,8 +530,23 @@ int runUnityTests(void) {
     // check return codes for wait function
     RUN_TEST(test_normal);
     RUN_TEST(test_random);
+    RUN_TEST(test_load);
+#if defined(RR_VIRTUAL_CLOCK) && defined(WITH_INTERVALL_ADAPTIVE)
+    // takes minutes in real time
+    RUN_TEST(test_adaptive);
+#endif
     RUN_TEST(test_abort);
+    RUN_TEST(test_abort_context);
+    RUN_TEST(test_functor);
+    RUN_TEST(test_poll);
+    RUN_TEST(test_phase);
     RUN_TEST(test_overflow);
+#ifdef WITH_INTERVALL_TRACE
+    RUN_TEST(test_trace);
+#endif
+#ifdef WITH_INTERVALL_REGISTRY
+    RUN_TEST(test_registry);
+#endif
     RUN_TEST(test_no_begin);
     RUN_TEST(test_isPeriodOver);
 
@@ -162,10 +566,7 @@ void loop() {
 }
 
 #else
-    #include <chrono>
-    #include <unistd.h>
 
-using namespace std::chrono;
 using namespace fakeit;
 
 long myRandom(long a, long b) {
@@ -176,27 +577,15 @@ long myRandom(long a, long b) {
     return r;
 }
 
-unsigned long myMillis(void) {
-    unsigned long t = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-
-    // TEST_PRINTF("t = %d", t);
-
-    return t;
-}
-
-void mySleep(unsigned long t) {
-    usleep(t * 1000);
-}
-
 // native environment
 int main() {
     When(OverloadedMethod(ArduinoFake(), random, long(long, long))).AlwaysDo([](long a, long b) -> long {
         return myRandom(a, b);
     });
-    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long t) -> void { return mySleep(t); });
-    When(Method(ArduinoFake(), millis)).AlwaysDo([](void) -> unsigned long { return myMillis(); });
-
-    When(Method(ArduinoFake(), yield)).AlwaysReturn();
+    // the library runs on the virtual clock (-DRR_VIRTUAL_CLOCK), so must the test
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long t) -> void { VirtualClock::delay(t); });
+    When(Method(ArduinoFake(), millis)).AlwaysDo([](void) -> unsigned long { return VirtualClock::millis(); });
+    When(Method(ArduinoFake(), yield)).AlwaysDo([](void) -> void { VirtualClock::yield(); });
 
     When(OverloadedMethod(ArduinoFake(Serial), begin, void(unsigned long))).AlwaysReturn();
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t())).AlwaysReturn();
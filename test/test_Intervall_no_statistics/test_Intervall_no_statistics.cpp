@@ -15,6 +15,7 @@
 #include <Arduino.h>
 #include <unity.h>
 
+#include "rr_Clock.h"
 #include "rr_DebugUtils.h"
 #include "rr_Intervall.h"
 
@@ -88,10 +89,7 @@ void loop() {
 }
 
 #else
-    #include <chrono>
-    #include <unistd.h>
 
-using namespace std::chrono;
 using namespace fakeit;
 
 long myRandom(long a, long b) {
@@ -102,27 +100,15 @@ long myRandom(long a, long b) {
     return r;
 }
 
-unsigned long myMillis(void) {
-    unsigned long t = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-
-    // TEST_PRINTF("t = %d", t);
-
-    return t;
-}
-
-void mySleep(unsigned long t) {
-    usleep(t * 1000);
-}
-
 // native environment
 int main() {
     When(OverloadedMethod(ArduinoFake(), random, long(long, long))).AlwaysDo([](long a, long b) -> long {
         return myRandom(a, b);
     });
-    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long t) -> void { return mySleep(t); });
-    When(Method(ArduinoFake(), millis)).AlwaysDo([](void) -> unsigned long { return myMillis(); });
-
-    When(Method(ArduinoFake(), yield)).AlwaysReturn();
+    // the library runs on the virtual clock (-DRR_VIRTUAL_CLOCK), so must the test
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long t) -> void { VirtualClock::delay(t); });
+    When(Method(ArduinoFake(), millis)).AlwaysDo([](void) -> unsigned long { return VirtualClock::millis(); });
+    When(Method(ArduinoFake(), yield)).AlwaysDo([](void) -> void { VirtualClock::yield(); });
 
     When(OverloadedMethod(ArduinoFake(Serial), begin, void(unsigned long))).AlwaysReturn();
     When(OverloadedMethod(ArduinoFake(Serial), println, size_t())).AlwaysReturn();
@@ -0,0 +1,124 @@
+//!
+//! @file test_Memory.cpp
+//! @author M. Nickels
+//! @brief unit test
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+//! code under test
+#include "rr_Memory.h"
+
+//! @cond
+
+// use the stack below the caller
+static uint8_t __attribute__((noinline)) useStack(void) {
+    volatile uint8_t area[256];
+
+    for (size_t index = 0; index < sizeof(area); index++)
+        area[index] = index;
+
+    return area[sizeof(area) - 1];
+}
+
+void test_stack(void) {
+    size_t unused;
+
+    MemoryInfo::begin();
+
+    unused = MemoryInfo::getStackHighWater();
+    TEST_PRINTF("stack high water: %lu", (unsigned long)unused);
+    TEST_ASSERT_GREATER_THAN(256, unused);
+
+    TEST_ASSERT_EQUAL(255, useStack());
+
+    // FreeRTOS does not repaint, the stack may have been deeper before
+#ifndef ARDUINO_ARCH_ESP32
+    TEST_ASSERT_LESS_OR_EQUAL(unused - 256, MemoryInfo::getStackHighWater());
+
+    // painting again restores the high water mark
+    MemoryInfo::begin();
+    TEST_ASSERT_UINT_WITHIN(64, unused, MemoryInfo::getStackHighWater());
+#endif
+}
+
+void test_heap(void) {
+    void*  blocks[4];
+    size_t freeRam;
+    size_t largest;
+
+#if defined(ARDUINO_ARCH_AVR) || !defined(ARDUINO)
+    // the heap has no holes yet
+    TEST_ASSERT_EQUAL(0, MemoryInfo::getFragmentation());
+#endif
+
+    for (uint8_t index = 0; index < 4; index++)
+        blocks[index] = malloc(32);
+
+    // holes between the remaining blocks
+    free(blocks[0]);
+    free(blocks[2]);
+
+    freeRam = MemoryInfo::getFreeRam();
+    largest = MemoryInfo::getLargestBlock();
+
+    TEST_PRINTF("free: %lu  largest: %lu  fragmentation: %u%%", (unsigned long)freeRam, (unsigned long)largest,
+                MemoryInfo::getFragmentation());
+    TEST_ASSERT_GREATER_THAN(0, freeRam);
+    TEST_ASSERT_LESS_OR_EQUAL(freeRam, largest);
+#ifdef ARDUINO_ARCH_AVR
+    // the holes are on the free list
+    TEST_ASSERT_GREATER_THAN(0, MemoryInfo::getFragmentation());
+#else
+    TEST_ASSERT_LESS_THAN(100, MemoryInfo::getFragmentation());
+#endif
+
+    free(blocks[1]);
+    free(blocks[3]);
+}
+
+void test_print(void) {
+    PRINT_MEMORY();
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_stack);
+    RUN_TEST(test_heap);
+    RUN_TEST(test_print);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+// native environment
+int main() {
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
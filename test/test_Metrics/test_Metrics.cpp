@@ -0,0 +1,276 @@
+//!
+//! @file test_Metrics.cpp
+//! @author M. Nickels
+//! @brief unit test
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_Clock.h"
+
+//! code under test
+#include "rr_Metrics.h"
+
+//! @cond
+
+#ifdef RR_VIRTUAL_CLOCK
+    #define DELAY(ms) VirtualClock::delay(ms)
+#else
+    #define DELAY(ms) delay(ms)
+#endif
+
+// records all written bytes, the exporter uses the virtual write(uint8_t) of Print and print() for the names
+class Capture : public Print {
+  public:
+    // ArduinoFake routes print() to its mock
+    size_t append(const char* text) {
+        size_t count = 0;
+
+        while (text[count] != 0)
+            write((uint8_t)text[count++]);
+
+        return count;
+    }
+
+    size_t write(uint8_t data) {
+        if (length < sizeof(buffer) - 1)
+            buffer[length++] = data;
+
+        buffer[length] = 0;
+
+        return 1;
+    }
+
+    void clear(void) {
+        length    = 0;
+        buffer[0] = 0;
+    }
+
+    char    buffer[200];
+    uint8_t length;
+};
+
+Capture sink;
+
+METRIC(MetricCounter, messages, "messages");
+METRIC(MetricGauge, queue, "queue");
+METRIC(MetricTimer, latency, "latency");
+
+// back to a defined state, the exports take the deltas
+void resetMetrics(void) {
+    Metric::Snapshot_t snapshot;
+
+    for (Metric* metric = Metric::getFirst(); metric != NULL; metric = metric->getNext())
+        metric->snapshot(snapshot);
+
+    sink.clear();
+}
+
+void test_registry(void) {
+    TEST_ASSERT_EQUAL(3, Metric::getCount());
+
+    // the last constructed metric is the first one
+    TEST_ASSERT_EQUAL_PTR(&latency, Metric::getFirst());
+    TEST_ASSERT_EQUAL(Metric::Timer, Metric::getFirst()->getType());
+
+    {
+        MetricCounter temporary(F("temporary"));
+
+        TEST_ASSERT_EQUAL(4, Metric::getCount());
+    }
+
+    TEST_ASSERT_EQUAL(3, Metric::getCount());
+}
+
+void test_values(void) {
+    Metric::Snapshot_t snapshot;
+    uint32_t           count;
+
+    resetMetrics();
+
+    count = messages.get();
+    messages.add();
+    messages.addAtomic(4);
+    TEST_ASSERT_EQUAL(count + 5, messages.get());
+
+    messages.snapshot(snapshot);
+    TEST_ASSERT_EQUAL(5, snapshot.delta);
+
+    queue.set(10);
+    queue.addAtomic(-3);
+    TEST_ASSERT_EQUAL(7, queue.get());
+
+    latency.add(100);
+    latency.addAtomic(300);
+    TEST_ASSERT_EQUAL(300, latency.getMax());
+
+    latency.snapshot(snapshot);
+    TEST_ASSERT_EQUAL(2, snapshot.delta);
+    TEST_ASSERT_EQUAL(200, snapshot.average);
+    TEST_ASSERT_EQUAL(300, snapshot.max);
+
+    // the maximum restarts with each export
+    TEST_ASSERT_EQUAL(0, latency.getMax());
+
+    queue.snapshot(snapshot);
+    queue.set(2);
+    queue.snapshot(snapshot);
+    TEST_ASSERT_EQUAL(2, (int32_t)snapshot.value);
+    TEST_ASSERT_EQUAL(-5, snapshot.delta);
+}
+
+void test_text(void) {
+    Intervall       intervall(1000);
+    MetricsExporter exporter(sink, intervall);
+    char            expected[100];
+    unsigned long   now;
+
+    resetMetrics();
+
+    messages.add(12);
+    queue.set(queue.get() + 3);
+    latency.add(120);
+    latency.add(80);
+
+    now = RR_MILLIS();
+    TEST_ASSERT_TRUE(exporter.poll());
+
+    snprintf(expected, sizeof(expected), "@%lu #0 latency=%lu+2/100/120 queue=%ld+3 messages=%lu+12\r\n", now,
+             (unsigned long)latency.getCount(), (long)queue.get(), (unsigned long)messages.get());
+    TEST_ASSERT_EQUAL_STRING(expected, sink.buffer);
+
+    // nothing to export within the period
+    sink.clear();
+    DELAY(500);
+    TEST_ASSERT_FALSE(exporter.poll());
+    TEST_ASSERT_EQUAL(0, sink.length);
+
+    DELAY(500);
+    now = RR_MILLIS();
+    TEST_ASSERT_TRUE(exporter.poll());
+
+    snprintf(expected, sizeof(expected), "@%lu #1 latency=%lu+0/0/0 queue=%ld+0 messages=%lu+0\r\n", now,
+             (unsigned long)latency.getCount(), (long)queue.get(), (unsigned long)messages.get());
+    TEST_ASSERT_EQUAL_STRING(expected, sink.buffer);
+}
+
+void test_binary(void) {
+    Intervall       intervall(1000);
+    MetricsExporter exporter(sink, intervall, MetricsExporter::Binary);
+    uint8_t         checksum = 0;
+
+    resetMetrics();
+
+    messages.add(3);
+    latency.add(50);
+
+    exporter.write();
+
+    // header, timer record, two records, checksum
+    TEST_ASSERT_EQUAL(1 + 1 + 4 + 1 + 18 + 10 + 10 + 1, sink.length);
+    TEST_ASSERT_EQUAL('M', sink.buffer[0]);
+    TEST_ASSERT_EQUAL(3, sink.buffer[6]);
+
+    // first record: latency
+    TEST_ASSERT_EQUAL(0, sink.buffer[7]);
+    TEST_ASSERT_EQUAL(Metric::Timer, sink.buffer[8]);
+    TEST_ASSERT_EQUAL(1, sink.buffer[13]);
+    TEST_ASSERT_EQUAL(50, sink.buffer[17]);
+
+    // last record: messages
+    TEST_ASSERT_EQUAL(2, sink.buffer[35]);
+    TEST_ASSERT_EQUAL(3, sink.buffer[41]);
+
+    for (uint8_t index = 0; index < sink.length; index++)
+        checksum += sink.buffer[index];
+
+    TEST_ASSERT_EQUAL(0xFF, checksum);
+}
+
+void test_names(void) {
+    Intervall       intervall(1000);
+    MetricsExporter exporter(sink, intervall);
+
+    sink.clear();
+    exporter.writeNames();
+
+    TEST_ASSERT_EQUAL_STRING("0 latency\r\n1 queue\r\n2 messages\r\n", sink.buffer);
+}
+
+#ifndef ARDUINO
+    #include <chrono>
+
+// the time of a plain and an atomic increment
+void test_benchmark(void) {
+    const unsigned loops = 1000000;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned loop = 0; loop < loops; loop++)
+        messages.add();
+
+    auto plain = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+
+    for (unsigned loop = 0; loop < loops; loop++)
+        messages.addAtomic();
+
+    auto atomic = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    TEST_PRINTF("ns/increment: plain %5.2f  atomic %5.2f", (double)plain.count() / loops,
+                (double)atomic.count() / loops);
+}
+#endif
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_registry);
+    RUN_TEST(test_values);
+    RUN_TEST(test_text);
+    RUN_TEST(test_binary);
+    RUN_TEST(test_names);
+#ifndef ARDUINO
+    RUN_TEST(test_benchmark);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+// native environment
+int main() {
+    When(OverloadedMethod(ArduinoFake(Print), print, size_t(const __FlashStringHelper*)))
+        .AlwaysDo([](const __FlashStringHelper* text) -> size_t {
+            return sink.append(reinterpret_cast<const char*>(text));
+        });
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
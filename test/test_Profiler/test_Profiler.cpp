@@ -0,0 +1,161 @@
+//!
+//! @file test_Profiler.cpp
+//! @author M. Nickels
+//! @brief unit test and benchmark
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_Clock.h"
+
+//! code under test
+#include "rr_Profiler.h"
+
+//! @cond
+
+#ifdef RR_VIRTUAL_CLOCK
+    #define BUSY_US(us) VirtualClock::delayMicroseconds(us)
+#else
+    #define BUSY_US(us) delayMicroseconds(us)
+#endif
+
+ProfileSite shortSite(F("short"));
+ProfileSite longSite(F("long"));
+
+void shortSection(void) {
+    ProfileScope scope(shortSite);
+
+    BUSY_US(10);
+}
+
+void longSection(void) {
+    ProfileScope scope(longSite);
+
+    BUSY_US(1000);
+}
+
+void test_sites(void) {
+    ProfileSite::calibrate();
+
+    for (unsigned loop = 0; loop < 100; loop++) {
+        shortSection();
+        shortSection();
+
+        if (loop % 10 == 0)
+            longSection();
+    }
+
+    TEST_ASSERT_EQUAL(200, shortSite.getCount());
+    TEST_ASSERT_EQUAL(10, longSite.getCount());
+
+    TEST_ASSERT_UINT_WITHIN(8, 10, shortSite.getMin());
+    TEST_ASSERT_UINT_WITHIN(8, 10, shortSite.getAvg());
+    TEST_ASSERT_UINT_WITHIN(8, 1000, longSite.getMax());
+    TEST_ASSERT_UINT_WITHIN(200 * 8, 200 * 10, (unsigned long)shortSite.getTotal());
+
+    // sorted by total time
+    ProfileSite::printReport();
+
+    TEST_ASSERT_EQUAL_PTR(&longSite, ProfileSite::getFirst());
+    TEST_ASSERT_EQUAL_PTR(&shortSite, longSite.getNext());
+
+    ProfileSite::resetAll();
+
+    TEST_ASSERT_EQUAL(0, shortSite.getCount());
+    TEST_ASSERT_EQUAL(0, (unsigned long)longSite.getTotal());
+}
+
+#if defined(__PLATFORMIO_BUILD_DEBUG__) && !defined(WITHOUT_PROFILER)
+unsigned profiled(unsigned value) {
+    PROFILE_SCOPE("profiled");
+
+    BUSY_US(5);
+
+    return value + 1;
+}
+
+void test_macro(void) {
+    ProfileSite* site;
+
+    for (unsigned loop = 0; loop < 50; loop++)
+        TEST_ASSERT_EQUAL(loop + 1, profiled(loop));
+
+    // the site registers itself on the first execution
+    site = ProfileSite::getFirst();
+
+    TEST_ASSERT_NOT_NULL(site);
+    TEST_ASSERT_EQUAL_STRING("profiled", (const char*)site->getName());
+    TEST_ASSERT_EQUAL(50, site->getCount());
+}
+#endif
+
+#ifndef ARDUINO
+    #include <chrono>
+
+// cost of a profiled section, measured with the real clock
+void test_overhead(void) {
+    const unsigned loops = 1000000;
+    ProfileSite    site(F("overhead"));
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned loop = 0; loop < loops; loop++) {
+        ProfileScope scope(site);
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    TEST_PRINTF("ns/section: %.1f", (double)ns.count() / loops);
+    TEST_ASSERT_EQUAL(loops, site.getCount());
+}
+#endif
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sites);
+#if defined(__PLATFORMIO_BUILD_DEBUG__) && !defined(WITHOUT_PROFILER)
+    RUN_TEST(test_macro);
+#endif
+#ifndef ARDUINO
+    RUN_TEST(test_overhead);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+using namespace fakeit;
+
+// native environment
+int main() {
+    When(Method(ArduinoFake(), micros)).AlwaysDo([](void) -> unsigned long { return VirtualClock::micros(); });
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
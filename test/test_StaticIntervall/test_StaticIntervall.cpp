@@ -0,0 +1,191 @@
+//!
+//! @file test_StaticIntervall.cpp
+//! @author M. Nickels
+//! @brief unit test
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_Clock.h"
+#include "rr_DebugUtils.h"
+
+//! code under test
+#include "rr_StaticIntervall.h"
+
+//! @cond
+
+const Intervall::Period_t period = 50; // 50 millis
+
+// RAM per instance compared to class Intervall
+void test_size(void) {
+    TEST_PRINTF("Intervall: %u  NoStats: %u  MinMax: %u  Full: %u  Histogram<8>: %u", (unsigned)sizeof(Intervall),
+                (unsigned)sizeof(StaticIntervall<period>),
+                (unsigned)sizeof(StaticIntervall<period, IntervallMinMaxStats>),
+                (unsigned)sizeof(StaticIntervall<period, IntervallFullStats>),
+                (unsigned)sizeof(StaticIntervall<period, IntervallHistogramStats<8, 10> >));
+
+    TEST_ASSERT_EQUAL(sizeof(unsigned long), sizeof(StaticIntervall<period>));
+    TEST_ASSERT_LESS_THAN(sizeof(Intervall), sizeof(StaticIntervall<period, IntervallMinMaxStats>));
+}
+
+// test a normal intervall with min/max statistics
+void test_normal(void) {
+    StaticIntervall<period, IntervallMinMaxStats> intervall;
+
+    intervall.begin();
+
+    for (unsigned loop = 0; loop < 5; loop++) {
+        delay(period - 10);
+
+        TEST_ASSERT_EQUAL(Intervall::Success, intervall.wait());
+    }
+
+    TEST_ASSERT_UINT_WITHIN(1, period - 10, intervall.getMaxPeriod());
+    TEST_ASSERT_UINT_WITHIN(1, period - 10, intervall.getMinPeriod());
+}
+
+// test overflowed intervall with full statistics
+void test_overflow(void) {
+    StaticIntervall<period, IntervallFullStats> intervall;
+
+    intervall.begin();
+
+    for (unsigned loop = 0; loop < 5; loop++) {
+        delay(period + 10);
+
+        TEST_ASSERT_EQUAL(Intervall::Overflow, intervall.wait());
+    }
+
+    TEST_ASSERT_UINT_WITHIN(1, period + 10, intervall.getAvgPeriod());
+}
+
+// test histogram statistics
+void test_histogram(void) {
+    StaticIntervall<period, IntervallHistogramStats<8, 10> > intervall;
+
+    intervall.begin();
+
+    for (unsigned loop = 0; loop < 3; loop++) {
+        delay(25);
+
+        intervall.wait();
+    }
+
+    TEST_ASSERT_EQUAL(3, intervall.getBucket(2));
+    TEST_ASSERT_EQUAL(0, intervall.getBucket(7));
+}
+
+// test failure without begin() before wait()
+void test_no_begin(void) {
+    StaticIntervall<period> intervall;
+
+    TEST_ASSERT_EQUAL(Intervall::Failure, intervall.wait());
+
+#ifdef RR_VIRTUAL_CLOCK
+    // a start at the time 0 must not look like an intervall without begin()
+    VirtualClock::set(0);
+    intervall.begin();
+    TEST_ASSERT_FALSE(intervall.isPeriodOver());
+#endif
+}
+
+// clock, which advances by one tick per reading, so each wait() succeeds without waiting
+struct StepClock {
+    static unsigned long ticks;
+
+    static unsigned long now(void) {
+        return ++ticks;
+    }
+};
+
+unsigned long StepClock::ticks = 1;
+
+#ifndef ARDUINO
+    #include <chrono>
+#endif
+
+// nanoseconds per wait() of a policy
+template <class Stats> unsigned long measureWait(void) {
+    StaticIntervall<2, Stats, StepClock> intervall;
+#ifdef ARDUINO
+    const unsigned long loops = 1000;
+    unsigned long       start = micros();
+#else
+    const unsigned long loops = 1000000;
+    auto                start = std::chrono::steady_clock::now();
+#endif
+
+    intervall.begin();
+
+    for (unsigned long loop = 0; loop < loops; loop++)
+        intervall.wait();
+
+#ifdef ARDUINO
+    return (micros() - start) * 1000 / loops;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() /
+           loops;
+#endif
+}
+
+// the cost of wait() per statistics policy
+void test_benchmark(void) {
+    TEST_PRINTF("ns/wait(): NoStats: %lu  MinMax: %lu  Full: %lu  Histogram<8>: %lu", measureWait<IntervallNoStats>(),
+                measureWait<IntervallMinMaxStats>(), measureWait<IntervallFullStats>(),
+                measureWait<IntervallHistogramStats<8, 10> >());
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_size);
+    RUN_TEST(test_normal);
+    RUN_TEST(test_overflow);
+    RUN_TEST(test_histogram);
+    RUN_TEST(test_no_begin);
+    RUN_TEST(test_benchmark);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+using namespace fakeit;
+
+// native environment
+int main() {
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long t) -> void { VirtualClock::delay(t); });
+    When(Method(ArduinoFake(), millis)).AlwaysDo([](void) -> unsigned long { return VirtualClock::millis(); });
+    When(Method(ArduinoFake(), yield)).AlwaysDo([](void) -> void { VirtualClock::yield(); });
+
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t())).AlwaysReturn();
+    When(OverloadedMethod(ArduinoFake(Serial), println, size_t(const char*))).AlwaysReturn();
+    When(OverloadedMethod(ArduinoFake(Serial), print, size_t(const char*))).AlwaysReturn();
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
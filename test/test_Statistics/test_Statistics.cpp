@@ -0,0 +1,157 @@
+//!
+//! @file test_Statistics.cpp
+//! @author M. Nickels
+//! @brief unit test
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+//! code under test
+#include "rr_Statistics.h"
+
+//! @cond
+
+// no samples at all
+void test_empty(void) {
+    RunningStatistics stats;
+
+    TEST_ASSERT_EQUAL(0, stats.getCount());
+    TEST_ASSERT_EQUAL(0, stats.getMax());
+    TEST_ASSERT_EQUAL(0, stats.getMean());
+    TEST_ASSERT_EQUAL(0, stats.getVariance());
+}
+
+// constant samples
+void test_constant(void) {
+    RunningStatistics stats;
+
+    for (unsigned loop = 0; loop < 100; loop++)
+        stats.add(490);
+
+    TEST_ASSERT_EQUAL(100, stats.getCount());
+    TEST_ASSERT_EQUAL(490, stats.getMin());
+    TEST_ASSERT_EQUAL(490, stats.getMax());
+    TEST_ASSERT_EQUAL(490, stats.getMean());
+    TEST_ASSERT_EQUAL(490, stats.getEwma());
+    TEST_ASSERT_EQUAL(0, stats.getVariance());
+    TEST_ASSERT_EQUAL(0, stats.getStdDev());
+}
+
+// alternating samples 10, 20, 10, 20, ...
+void test_variance(void) {
+    RunningStatistics stats;
+
+    for (unsigned loop = 0; loop < 1000; loop++)
+        stats.add(loop & 1 ? 20 : 10);
+
+    TEST_ASSERT_EQUAL(10, stats.getMin());
+    TEST_ASSERT_EQUAL(20, stats.getMax());
+    TEST_ASSERT_UINT_WITHIN(1, 15, stats.getMean());
+    TEST_ASSERT_UINT_WITHIN(1, 25, stats.getVariance());
+    TEST_ASSERT_EQUAL(5, stats.getStdDev());
+}
+
+// step response of the moving average
+void test_ewma(void) {
+    RunningStatistics stats;
+
+    stats.setEwmaShift(2);
+
+    stats.add(100);
+    TEST_ASSERT_EQUAL(100, stats.getEwma());
+
+    stats.add(200);
+    TEST_ASSERT_EQUAL(125, stats.getEwma());
+
+    for (unsigned loop = 0; loop < 100; loop++)
+        stats.add(200);
+
+    TEST_ASSERT_UINT_WITHIN(1, 200, stats.getEwma());
+}
+
+// a long uptime must neither overflow nor lose the history
+void test_long_run(void) {
+    RunningStatistics stats;
+
+    for (unsigned long loop = 0; loop < 200000UL; loop++)
+        stats.add(60000);
+
+    stats.add(60010);
+
+    TEST_ASSERT_EQUAL(200001UL, stats.getCount());
+    TEST_ASSERT_EQUAL(60000, stats.getMean());
+    TEST_ASSERT_EQUAL(0, stats.getStdDev());
+    TEST_ASSERT_EQUAL(60010, stats.getMax());
+}
+
+// a step change after the window is saturated must still move the mean
+void test_step(void) {
+    RunningStatistics stats;
+
+    for (unsigned long loop = 0; loop < 10000UL; loop++)
+        stats.add(100);
+
+    for (unsigned long loop = 0; loop < 100000UL; loop++)
+        stats.add(115);
+
+    TEST_ASSERT_EQUAL(115, stats.getMean());
+    TEST_ASSERT_EQUAL(115, stats.getEwma());
+    TEST_ASSERT_EQUAL(0, stats.getStdDev());
+}
+
+// samples beyond the fixed point format saturate
+void test_large(void) {
+    RunningStatistics stats;
+
+    stats.add(1UL << 24);
+    stats.add(1UL << 24);
+
+    TEST_ASSERT_EQUAL((1UL << 23) - 1, stats.getMean());
+    TEST_ASSERT_EQUAL(1UL << 24, stats.getMax());
+}
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty);
+    RUN_TEST(test_constant);
+    RUN_TEST(test_variance);
+    RUN_TEST(test_ewma);
+    RUN_TEST(test_long_run);
+    RUN_TEST(test_step);
+    RUN_TEST(test_large);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+// native environment
+int main() {
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
@@ -0,0 +1,217 @@
+//!
+//! @file test_Task.cpp
+//! @author M. Nickels
+//! @brief unit test
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_Clock.h"
+
+//! code under test
+#include "rr_Task.h"
+
+//! @cond
+
+// a sequence of delays
+unsigned      steps = 0;
+unsigned long stepTime[3];
+
+bool sequence(Task_t* task) {
+    TASK_BEGIN(task);
+
+    stepTime[steps++] = millis();
+
+    TASK_AWAIT_MS(task, 100);
+
+    stepTime[steps++] = millis();
+
+    TASK_AWAIT_MS(task, 50);
+
+    stepTime[steps++] = millis();
+
+    TASK_END(task);
+}
+
+// a periodic task driven by an intervall
+Intervall periodic(20);
+unsigned  periods = 0;
+
+bool periodicTask(Task_t* task) {
+    TASK_BEGIN(task);
+
+    periodic.begin();
+
+    for (;;) {
+        TASK_AWAIT_PERIOD(task, periodic);
+
+        periods++;
+    }
+
+    TASK_END(task);
+}
+
+// a task waiting for a condition
+bool     flag    = false;
+unsigned flagged = 0;
+
+bool conditionTask(Task_t* task) {
+    TASK_BEGIN(task);
+
+    TASK_AWAIT(task, flag);
+
+    flagged++;
+
+    TASK_END(task);
+}
+
+void test_sequence(void) {
+    Task_t task;
+
+    TASK_INIT(&task);
+    steps = 0;
+
+    TEST_ASSERT_TRUE(sequence(&task));
+    TEST_ASSERT_EQUAL(1, steps);
+
+    // too early
+    delay(99);
+    TEST_ASSERT_TRUE(sequence(&task));
+    TEST_ASSERT_EQUAL(1, steps);
+
+    delay(1);
+    TEST_ASSERT_TRUE(sequence(&task));
+    TEST_ASSERT_EQUAL(2, steps);
+
+    delay(50);
+    TEST_ASSERT_FALSE(sequence(&task));
+    TEST_ASSERT_EQUAL(3, steps);
+
+    TEST_ASSERT_EQUAL(100, stepTime[1] - stepTime[0]);
+    TEST_ASSERT_EQUAL(50, stepTime[2] - stepTime[1]);
+
+    // finished tasks stay finished
+    TEST_ASSERT_FALSE(sequence(&task));
+    TEST_ASSERT_EQUAL(3, steps);
+}
+
+void test_scheduler(void) {
+    TaskEntry_t   entries[] = {{sequence, {0, 0}}, {periodicTask, {0, 0}}, {conditionTask, {0, 0}}};
+    TaskScheduler scheduler(entries, sizeof(entries) / sizeof(entries[0]));
+    unsigned long start = millis();
+
+    steps   = 0;
+    periods = 0;
+    flag    = false;
+    flagged = 0;
+
+    while (millis() - start < 1000) {
+        scheduler.run();
+
+        if (millis() - start >= 500)
+            flag = true;
+
+        delay(1);
+    }
+
+    TEST_ASSERT_EQUAL(3, steps);
+    TEST_ASSERT_UINT_WITHIN(1, 1000 / 20, periods);
+    TEST_ASSERT_EQUAL(1, flagged);
+
+    // only the periodic task is left
+    TEST_ASSERT_EQUAL(1, scheduler.run());
+    TEST_ASSERT_LESS_OR_EQUAL(20, scheduler.getIdleTime());
+}
+
+#ifdef __cpp_impl_coroutine
+
+unsigned coPeriods = 0;
+
+CoTask coPeriodic(Intervall& intervall) {
+    unsigned local = 0;
+
+    intervall.begin();
+
+    co_await sleepFor(100);
+
+    while (local < 10) {
+        co_await nextPeriod(intervall);
+
+        // local variables survive the suspension
+        local++;
+        coPeriods = local;
+    }
+
+    co_await until([] { return flag; });
+}
+
+void test_coroutine(void) {
+    Intervall     intervall(20);
+    CoTask        task  = coPeriodic(intervall);
+    unsigned long start = millis();
+
+    coPeriods = 0;
+    flag      = false;
+
+    while (task.run() && millis() - start < 1000) {
+        if (millis() - start >= 500)
+            flag = true;
+
+        delay(1);
+    }
+
+    TEST_ASSERT_EQUAL(10, coPeriods);
+    TEST_ASSERT_TRUE(millis() - start >= 500);
+    TEST_ASSERT_FALSE(task.run());
+}
+
+#endif
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sequence);
+    RUN_TEST(test_scheduler);
+#ifdef __cpp_impl_coroutine
+    RUN_TEST(test_coroutine);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+using namespace fakeit;
+
+// native environment
+int main() {
+    When(Method(ArduinoFake(), delay)).AlwaysDo([](unsigned long t) -> void { VirtualClock::delay(t); });
+    When(Method(ArduinoFake(), millis)).AlwaysDo([](void) -> unsigned long { return VirtualClock::millis(); });
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
@@ -0,0 +1,206 @@
+//!
+//! @file test_TimerWheel.cpp
+//! @author M. Nickels
+//! @brief unit test and benchmark
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+//! code under test
+#include "rr_TimerWheel.h"
+
+//! @cond
+
+#ifdef ARDUINO
+const size_t poolSize = 16;
+#else
+const size_t poolSize = 100000;
+#endif
+
+TimerWheel::Timer_t pool[poolSize];
+
+// expected expiry time of a timer, checked in the callback
+struct Expectation {
+    TimerWheel*        wheel;
+    TimerWheel::Tick_t expires;
+    TimerWheel::Tick_t interval;
+    unsigned           calls;
+    bool               late;
+};
+
+void checkExpiry(void* context) {
+    Expectation* expectation = (Expectation*)context;
+
+    if (expectation->wheel->getTime() != expectation->expires)
+        expectation->late = true;
+
+    expectation->expires += expectation->interval;
+    expectation->calls++;
+}
+
+// one shot timers expire exactly once at the right tick
+void test_oneShot(void) {
+    TimerWheel         wheel(pool, 4, 1000);
+    TimerWheel::Tick_t delays[] = {0, 1, 15, 16, 63, 64, 65, 300, 4095, 4096, 60000};
+
+    for (unsigned loop = 0; loop < sizeof(delays) / sizeof(delays[0]); loop++) {
+        Expectation expectation = {&wheel, wheel.getTime() + (delays[loop] ? delays[loop] : 1), 0, 0, false};
+
+        TEST_ASSERT_NOT_NULL(wheel.start(delays[loop], checkExpiry, &expectation));
+        TEST_ASSERT_EQUAL(1, wheel.getCount());
+
+        wheel.tick(wheel.getTime() + delays[loop] + 100);
+
+        TEST_ASSERT_EQUAL(1, expectation.calls);
+        TEST_ASSERT_FALSE(expectation.late);
+        TEST_ASSERT_EQUAL(0, wheel.getCount());
+    }
+}
+
+// periodic timers keep their phase
+void test_periodic(void) {
+    TimerWheel  wheel(pool, 4);
+    Expectation fast = {&wheel, 7, 7, 0, false};
+    Expectation slow = {&wheel, 100, 100, 0, false};
+
+    wheel.start(7, checkExpiry, &fast, 7);
+    wheel.start(100, checkExpiry, &slow, 100);
+
+    wheel.tick(10000);
+
+    TEST_ASSERT_EQUAL(10000 / 7, fast.calls);
+    TEST_ASSERT_EQUAL(100, slow.calls);
+    TEST_ASSERT_FALSE(fast.late);
+    TEST_ASSERT_FALSE(slow.late);
+    TEST_ASSERT_EQUAL(2, wheel.getCount());
+}
+
+// stopped timers do not expire and return to the pool
+void test_stop(void) {
+    TimerWheel           wheel(pool, 2);
+    Expectation          expectation = {&wheel, 0, 0, 0, false};
+    TimerWheel::Timer_t* first       = wheel.start(10, checkExpiry, &expectation);
+    TimerWheel::Timer_t* second      = wheel.start(5000, checkExpiry, &expectation);
+
+    // pool exhausted
+    TEST_ASSERT_NULL(wheel.start(10, checkExpiry, &expectation));
+
+    TEST_ASSERT_TRUE(wheel.stop(first));
+    TEST_ASSERT_TRUE(wheel.stop(second));
+    TEST_ASSERT_FALSE(wheel.stop(second));
+
+    wheel.tick(10000);
+
+    TEST_ASSERT_EQUAL(0, expectation.calls);
+    TEST_ASSERT_NOT_NULL(wheel.start(10, checkExpiry, &expectation));
+}
+
+// many random timers across all levels
+void test_random(void) {
+    const size_t count = poolSize < 1000 ? poolSize : 1000;
+    TimerWheel   wheel(pool, count, 12345);
+    Expectation  expectations[count];
+    unsigned     expired;
+
+    for (size_t loop = 0; loop < count; loop++) {
+        TimerWheel::Tick_t delay = random(1, 60000);
+
+        expectations[loop] = {&wheel, wheel.getTime() + delay, 0, 0, false};
+        wheel.start(delay, checkExpiry, &expectations[loop]);
+    }
+
+    expired = wheel.tick(wheel.getTime() + 60000);
+
+    TEST_ASSERT_EQUAL(count, expired);
+
+    for (size_t loop = 0; loop < count; loop++) {
+        TEST_ASSERT_EQUAL(1, expectations[loop].calls);
+        TEST_ASSERT_FALSE(expectations[loop].late);
+    }
+}
+
+#ifndef ARDUINO
+    #include <chrono>
+
+void countExpiry(void* context) {
+    (*(unsigned long*)context)++;
+}
+
+// cost per tick with a growing number of periodic timers
+void test_benchmark(void) {
+    const TimerWheel::Tick_t ticks   = 10000;
+    size_t                   sizes[] = {100, 1000, 10000, 100000};
+
+    for (unsigned loop = 0; loop < sizeof(sizes) / sizeof(sizes[0]); loop++) {
+        TimerWheel    wheel(pool, sizes[loop]);
+        unsigned long expired = 0;
+
+        for (size_t timer = 0; timer < sizes[loop]; timer++) {
+            TimerWheel::Tick_t interval = random(10, 100000);
+
+            wheel.start(random(1, interval), countExpiry, &expired, interval);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        wheel.tick(ticks);
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+        TEST_PRINTF("timers: %6u  expired: %6lu  ns/tick: %8.1f", (unsigned)sizes[loop], expired,
+                    (double)ns.count() / ticks);
+    }
+}
+#endif
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_oneShot);
+    RUN_TEST(test_periodic);
+    RUN_TEST(test_stop);
+    RUN_TEST(test_random);
+#ifndef ARDUINO
+    RUN_TEST(test_benchmark);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+using namespace fakeit;
+
+// native environment
+int main() {
+    When(OverloadedMethod(ArduinoFake(), random, long(long, long))).AlwaysDo([](long a, long b) -> long {
+        return rand() % (b - a) + a;
+    });
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond
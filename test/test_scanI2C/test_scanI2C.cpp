@@ -0,0 +1,308 @@
+//!
+//! @file test_scanI2C.cpp
+//! @author M. Nickels
+//! @brief unit test and benchmark with a simulated I2C bus
+//! @note Run tests with 'pio test -e test_native'
+//!
+//! This file is part of the Application "rr_ArduinoUtils".
+//!
+//!      Creative Commons Attribution-ShareAlike 4.0 International License.
+//!
+//! To view a copy of this license, visit http://creativecommons.org/licenses/by-sa/4.0/
+//! or send a letter to Creative Commons, PO Box 1866, Mountain View, CA 94042, USA.
+//!
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "rr_DebugUtils.h"
+#include "rr_MockI2CBus.h"
+
+//! code under test
+#include "rr_I2CDevices.h"
+#include "rr_scanI2C.h"
+
+//! @cond
+
+MockI2CBus bus;
+
+// three devices at 100 kHz
+void resetBus(void) {
+    bus = MockI2CBus();
+
+    bus.addDevice(0x3C);
+    bus.addDevice(0x68);
+    bus.addDevice(0x76);
+}
+
+void test_scan(void) {
+    I2CMap_t map;
+
+    resetBus();
+
+    TEST_ASSERT_EQUAL(3, scanI2C(bus, map));
+    TEST_ASSERT_EQUAL(112, bus.getTransactions());
+
+    TEST_ASSERT_TRUE(isI2CPresent(map, 0x3C));
+    TEST_ASSERT_TRUE(isI2CPresent(map, 0x68));
+    TEST_ASSERT_TRUE(isI2CPresent(map, 0x76));
+    TEST_ASSERT_EQUAL(3, countI2C(map));
+
+    // range
+    TEST_ASSERT_EQUAL(1, scanI2C(bus, map, 0x40, 0x70));
+    TEST_ASSERT_FALSE(isI2CPresent(map, 0x3C));
+    TEST_ASSERT_TRUE(isI2CPresent(map, 0x68));
+}
+
+void test_faults(void) {
+    I2CMap_t map;
+
+    resetBus();
+
+    // error 4 and NAK are no devices
+    bus.setFault(0x3C, 4);
+    bus.setFault(0x68, 2);
+    bus.setFault(0x76, 3);
+
+    TEST_ASSERT_EQUAL(1, scanI2C(bus, map));
+    TEST_ASSERT_TRUE(isI2CPresent(map, 0x76));
+
+    // a NAK on data
+    bus.beginTransmission(0x76);
+    bus.write(0x00);
+    TEST_ASSERT_EQUAL(3, bus.endTransmission());
+
+    // reads are not affected
+    TEST_ASSERT_EQUAL(2, bus.requestFrom(0x76, 2));
+    TEST_ASSERT_EQUAL(0, bus.requestFrom(0x3C, 2));
+}
+
+void test_clock(void) {
+    I2CMap_t      map;
+    unsigned long start = VirtualClock::micros();
+
+    resetBus();
+
+    // 9 bits per probe
+    scanI2C(bus, map, I2C_FIRST_ADDRESS, I2C_LAST_ADDRESS, 100000);
+    TEST_ASSERT_EQUAL(112 * 90, VirtualClock::micros() - start);
+
+    bus.resetStatistics();
+    scanI2C(bus, map, I2C_FIRST_ADDRESS, I2C_LAST_ADDRESS, 400000);
+    TEST_ASSERT_EQUAL(112 * 23, bus.getBusyTime());
+
+    bus.resetStatistics();
+    bus.setLatency(10);
+    scanI2C(bus, map, I2C_FIRST_ADDRESS, I2C_LAST_ADDRESS, 1000000);
+    TEST_ASSERT_EQUAL(112 * 19, bus.getBusyTime());
+}
+
+void test_scanner(void) {
+    I2CBusScanner<MockI2CBus> scanner(bus);
+    unsigned                  steps = 1;
+    I2CMap_t                  map;
+
+    resetBus();
+
+    // 90 us per probe, 3 probes fit into 300 us
+    while (!scanner.step(255, 300))
+        steps++;
+
+    TEST_ASSERT_EQUAL(38, steps);
+    TEST_ASSERT_EQUAL(90, scanner.getProbeTime());
+    TEST_ASSERT_EQUAL(3, scanner.getCount());
+
+    scanI2C(bus, map);
+    TEST_ASSERT_EQUAL_MEMORY(map, scanner.getMap(), sizeof(I2CMap_t));
+
+    // a slow scan is forgotten after the next complete scan
+    bus.setLatency(210);
+    while (!scanner.step(255, 300))
+        ;
+    TEST_ASSERT_EQUAL(300, scanner.getProbeTime());
+
+    bus.setLatency(0);
+    scanner.step(1);
+    TEST_ASSERT_EQUAL(300, scanner.getProbeTime());
+
+    while (!scanner.step(255, 300))
+        ;
+    TEST_ASSERT_EQUAL(90, scanner.getProbeTime());
+}
+
+struct Changes {
+    uint8_t added;
+    uint8_t removed;
+    uint8_t last;
+};
+
+void onChange(uint8_t address, bool present, void* context) {
+    Changes* changes = (Changes*)context;
+
+    if (present)
+        changes->added++;
+    else
+        changes->removed++;
+
+    changes->last = address;
+}
+
+void test_inventory(void) {
+    Changes                     changes = {0, 0, 0};
+    I2CBusInventory<MockI2CBus> inventory(bus, onChange, &changes);
+    unsigned                    calls   = 0;
+
+    resetBus();
+
+    TEST_ASSERT_EQUAL(3, inventory.begin());
+    TEST_ASSERT_EQUAL(0, inventory.verify());
+
+    // removal is detected by the next verification
+    bus.removeDevice(0x68);
+    TEST_ASSERT_EQUAL(1, inventory.verify());
+    TEST_ASSERT_EQUAL(1, changes.removed);
+    TEST_ASSERT_EQUAL(0x68, changes.last);
+    TEST_ASSERT_FALSE(inventory.isPresent(0x68));
+
+    // hot plugged device is detected within a rotation of the unknown addresses
+    bus.addDevice(0x20);
+    bus.resetStatistics();
+
+    while (inventory.verify() == 0)
+        calls++;
+
+    TEST_ASSERT_LESS_OR_EQUAL(110 / 4, calls);
+    TEST_ASSERT_EQUAL(1, changes.added);
+    TEST_ASSERT_EQUAL(0x20, changes.last);
+    TEST_ASSERT_EQUAL(3, inventory.getCount());
+
+    // bus traffic compared to a full scan per call
+    TEST_PRINTF("inventory: %lu probes, full scans: %u probes", bus.getTransactions(), (calls + 1) * 112);
+    TEST_ASSERT_LESS_THAN((calls + 1) * 112 / 10, bus.getTransactions());
+}
+
+void test_lookup(void) {
+    I2CChipId entry;
+    I2CChipId previous;
+
+    TEST_ASSERT_EQUAL_STRING("SSD1306, SH1106", (const char*)lookupI2C(0x3C));
+    TEST_ASSERT_EQUAL_STRING("VEML7700, VEML6075", (const char*)lookupI2C(0x10));
+    TEST_ASSERT_NOT_NULL(lookupI2C(0x77));
+    TEST_ASSERT_NULL(lookupI2C(0x08));
+    TEST_ASSERT_NULL(lookupI2C(0x7F));
+
+    // the chip IDs are sorted for the binary search
+    TEST_ASSERT_TRUE(getI2CChipId(0, previous));
+
+    for (uint8_t index = 1; getI2CChipId(index, entry); index++) {
+        TEST_ASSERT_TRUE(entry.address > previous.address ||
+                         (entry.address == previous.address && entry.reg >= previous.reg));
+        previous = entry;
+    }
+
+    TEST_ASSERT_EQUAL(0, findI2CChipId(0x00));
+    TEST_ASSERT_EQUAL(getI2CChipIds(), findI2CChipId(0x78));
+    TEST_ASSERT_TRUE(getI2CChipId(findI2CChipId(0x76), entry));
+    TEST_ASSERT_EQUAL(0x76, entry.address);
+}
+
+void test_identify(void) {
+    I2CMap_t map;
+
+    resetBus();
+
+    // BME280 and MPU6050
+    bus.setRegister(0x76, 0xD0, 0x60);
+    bus.setRegister(0x68, 0x75, 0x68);
+
+    // one register read for all candidates
+    TEST_ASSERT_EQUAL_STRING("BME280", (const char*)identifyI2C(bus, 0x76));
+    TEST_ASSERT_EQUAL(2, bus.getTransactions());
+
+    TEST_ASSERT_EQUAL_STRING("MPU6050", (const char*)identifyI2C(bus, 0x68));
+
+    // no chip ID, the candidates remain
+    TEST_ASSERT_EQUAL_STRING("SSD1306, SH1106", (const char*)identifyI2C(bus, 0x3C));
+
+    bus.setRegister(0x76, 0xD0, 0x42);
+    TEST_ASSERT_EQUAL_STRING("BMP280, BME280, BME680, MS5611", (const char*)identifyI2C(bus, 0x76));
+
+    scanI2C(bus, map);
+    printI2C(bus, map);
+    printI2C(map);
+
+    // register access
+    bus.beginTransmission(0x76);
+    bus.write(0x10);
+    bus.write(0xAB);
+    bus.write(0xCD);
+    TEST_ASSERT_EQUAL(0, bus.endTransmission());
+    TEST_ASSERT_EQUAL_HEX8(0xCD, bus.getRegister(0x76, 0x11));
+}
+
+#ifndef ARDUINO
+    #include <chrono>
+
+// cost of a simulated scan without the bus time
+void test_benchmark(void) {
+    const unsigned loops = 10000;
+    I2CMap_t       map;
+
+    resetBus();
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned loop = 0; loop < loops; loop++)
+        scanI2C(bus, map);
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    TEST_PRINTF("ns/probe: %.1f, simulated us/scan at 100 kHz: %lu", (double)ns.count() / loops / 112,
+                bus.getBusyTime() / loops);
+    TEST_ASSERT_EQUAL(loops * 112, bus.getTransactions());
+}
+#endif
+
+int runUnityTests(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_scan);
+    RUN_TEST(test_faults);
+    RUN_TEST(test_clock);
+    RUN_TEST(test_scanner);
+    RUN_TEST(test_inventory);
+    RUN_TEST(test_lookup);
+    RUN_TEST(test_identify);
+#ifndef ARDUINO
+    RUN_TEST(test_benchmark);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+
+// embedded environment
+void setup() {
+    delay(2000);
+
+    runUnityTests();
+}
+
+void loop() {
+}
+
+#else
+
+using namespace fakeit;
+
+// native environment
+int main() {
+    When(Method(ArduinoFake(), micros)).AlwaysDo([](void) -> unsigned long { return VirtualClock::micros(); });
+
+    return runUnityTests();
+}
+
+#endif
+
+//! @endcond